@@ -44,6 +44,7 @@ Array2<maze::Cell> maze::generate(const Array2<bool>& map, Random& rng, math::Ve
     Array2<Cell> layout(map.width(), map.height());
 
     std::vector<math::Vec2i> open_nodes;
+    std::vector<math::Vec2i> neighbours;
     open_nodes.emplace_back(start);
 
     while(!open_nodes.empty())
@@ -53,7 +54,7 @@ Array2<maze::Cell> maze::generate(const Array2<bool>& map, Random& rng, math::Ve
         auto& tile = layout.at(pos.x, pos.y);
         tile.x = pos.x;
         tile.y = pos.y;
-        std::vector<math::Vec2i> neighbours;
+        neighbours.clear();
         if (!tile.exits[Direction::North] && try_add(neighbours, pos + -math::Vec2i::AxisY, layout, map))
         {
             tile.exits[Direction::North] = true;
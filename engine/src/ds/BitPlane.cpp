@@ -0,0 +1,157 @@
+#include "BitPlane.h"
+
+#include <algorithm>
+
+const int BitPlane::WordBits;
+
+BitPlane::Window BitPlane::Window::merged(const Window& other) const
+{
+    if (empty()) { return other; }
+    if (other.empty()) { return *this; }
+    return {
+        std::min(first_row, other.first_row),
+        std::max(last_row, other.last_row),
+        std::min(first_word, other.first_word),
+        std::max(last_word, other.last_word),
+    };
+}
+
+void BitPlane::resize(int width, int height)
+{
+    T3D_ASSERT(width >= 0 && height >= 0);
+    _width = width;
+    _height = height;
+    words_per_row = (width + WordBits - 1) / WordBits;
+    words.assign(static_cast<std::size_t>(words_per_row) * height, 0);
+}
+
+void BitPlane::clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void BitPlane::clear(const Window& window)
+{
+    const Window clipped = clip(window);
+    if (clipped.empty()) { return; }
+
+    for (int y = clipped.first_row; y <= clipped.last_row; ++y)
+    {
+        Word* row = &words[y * words_per_row];
+        std::fill(row + clipped.first_word, row + clipped.last_word + 1, 0);
+    }
+}
+
+BitPlane::Window BitPlane::clip(const Window& window) const
+{
+    return {
+        std::max(window.first_row, 0),
+        std::min(window.last_row, _height - 1),
+        std::max(window.first_word, 0),
+        std::min(window.last_word, words_per_row - 1),
+    };
+}
+
+bool BitPlane::any() const
+{
+    for (Word word : words)
+    {
+        if (word) { return true; }
+    }
+    return false;
+}
+
+std::size_t BitPlane::count() const
+{
+    std::size_t total = 0;
+    for (Word word : words)
+    {
+        for (; word; word &= word - 1)
+        {
+            ++total;
+        }
+    }
+    return total;
+}
+
+BitPlane& BitPlane::operator|=(const BitPlane& rhs)
+{
+    T3D_ASSERT(words.size() == rhs.words.size());
+    for (std::size_t index = 0; index < words.size(); ++index)
+    {
+        words[index] |= rhs.words[index];
+    }
+    return *this;
+}
+
+BitPlane& BitPlane::operator&=(const BitPlane& rhs)
+{
+    T3D_ASSERT(words.size() == rhs.words.size());
+    for (std::size_t index = 0; index < words.size(); ++index)
+    {
+        words[index] &= rhs.words[index];
+    }
+    return *this;
+}
+
+BitPlane& BitPlane::and_not(const BitPlane& rhs)
+{
+    T3D_ASSERT(words.size() == rhs.words.size());
+    for (std::size_t index = 0; index < words.size(); ++index)
+    {
+        words[index] &= ~rhs.words[index];
+    }
+    return *this;
+}
+
+void BitPlane::merge(const BitPlane& rhs, const Window& window)
+{
+    T3D_ASSERT(words.size() == rhs.words.size());
+    const Window clipped = clip(window);
+    if (clipped.empty()) { return; }
+
+    for (int y = clipped.first_row; y <= clipped.last_row; ++y)
+    {
+        const std::size_t row_offset = static_cast<std::size_t>(y) * words_per_row;
+        for (int word_index = clipped.first_word; word_index <= clipped.last_word; ++word_index)
+        {
+            words[row_offset + word_index] |= rhs.words[row_offset + word_index];
+        }
+    }
+}
+
+BitPlane::Window BitPlane::dilate(const BitPlane& source, const BitPlane& mask, const BitPlane& exclude, BitPlane& result, const Window& window)
+{
+    T3D_ASSERT(source.words.size() == mask.words.size() && source.words.size() == exclude.words.size() && source.words.size() == result.words.size());
+    const Window clipped = source.clip(window);
+    Window set_window;
+    if (clipped.empty()) { return set_window; }
+
+    const int words_per_row = source.words_per_row;
+    for (int y = clipped.first_row; y <= clipped.last_row; ++y)
+    {
+        const std::size_t row_offset = static_cast<std::size_t>(y) * words_per_row;
+        const Word* row = &source.words[row_offset];
+        const Word* row_above = y > 0 ? row - words_per_row : nullptr;
+        const Word* row_below = y + 1 < source._height ? row + words_per_row : nullptr;
+        for (int word_index = clipped.first_word; word_index <= clipped.last_word; ++word_index)
+        {
+            const Word word = row[word_index];
+            // Bits move towards higher x with a left shift, carrying over from the neighbouring words
+            Word grown = (word << 1) | (word >> 1);
+            if (word_index > 0) { grown |= row[word_index - 1] >> (WordBits - 1); }
+            if (word_index + 1 < words_per_row) { grown |= row[word_index + 1] << (WordBits - 1); }
+            if (row_above) { grown |= row_above[word_index]; }
+            if (row_below) { grown |= row_below[word_index]; }
+
+            // The mask keeps the padding bits clear
+            const Word next = grown & mask.words[row_offset + word_index] & ~exclude.words[row_offset + word_index];
+            result.words[row_offset + word_index] = next;
+            if (next)
+            {
+                set_window = set_window.merged({y, y, word_index, word_index});
+            }
+        }
+    }
+    return set_window;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <diag/Assert.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if WIN32
+#include <intrin.h>
+#endif
+
+// One bit per cell of a 2D grid, 64 cells of a row per word.
+// Bits past the width of a row are always zero, so whole words can be combined without masking.
+class BitPlane
+{
+public:
+    using Word = std::uint64_t;
+    static const int WordBits = 64;
+
+    // Rows and word columns of a plane, used to only touch the part of a plane that can hold set bits
+    struct Window
+    {
+        Window() {} // Empty
+        Window(int first_row, int last_row, int first_word, int last_word)
+            : first_row(first_row), last_row(last_row), first_word(first_word), last_word(last_word)
+        {}
+
+        int first_row = 0;
+        int last_row = -1;
+        int first_word = 0;
+        int last_word = -1;
+
+        bool empty() const { return first_row > last_row || first_word > last_word; }
+        Window merged(const Window& other) const;
+        Window grown(int rows, int words) const { return {first_row - rows, last_row + rows, first_word - words, last_word + words}; }
+    };
+
+    BitPlane() {}
+    BitPlane(int width, int height) { resize(width, height); }
+
+    // Clears all bits
+    void resize(int width, int height);
+    void clear();
+    void clear(const Window& window);
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < _width && y < _height; }
+    Window get_window() const { return {0, _height - 1, 0, words_per_row - 1}; }
+    Window get_window(int x, int y) const { return {y, y, x / WordBits, x / WordBits}; }
+    Window clip(const Window& window) const;
+
+    bool get(int x, int y) const { return (get_word(x, y) >> (x % WordBits)) & 1; }
+    void set(int x, int y) { get_word(x, y) |= Word(1) << (x % WordBits); }
+    void reset(int x, int y) { get_word(x, y) &= ~(Word(1) << (x % WordBits)); }
+
+    bool any() const;
+    std::size_t count() const;
+
+    BitPlane& operator|=(const BitPlane& rhs);
+    BitPlane& operator&=(const BitPlane& rhs);
+    BitPlane& and_not(const BitPlane& rhs);
+    void merge(const BitPlane& rhs, const Window& window); // Or within the window only
+    bool operator==(const BitPlane& rhs) const { return _width == rhs._width && _height == rhs._height && words == rhs.words; }
+    bool operator!=(const BitPlane& rhs) const { return !(*this == rhs); }
+
+    // Overwrites the window of result with the cells next to a set cell of source that are set in mask and not in
+    // exclude. Returns the smallest window holding the set bits of result that were written.
+    static Window dilate(const BitPlane& source, const BitPlane& mask, const BitPlane& exclude, BitPlane& result, const Window& window);
+
+    // callback(int x, int y) for every set bit, in row order
+    template<typename CallbackType>
+    void for_each_set(CallbackType callback) const { for_each_set(get_window(), callback); }
+    template<typename CallbackType>
+    void for_each_set(const Window& window, CallbackType callback) const;
+
+    static int find_lowest_bit(Word word);
+
+private:
+    Word& get_word(int x, int y) { T3D_ASSERT(contains(x, y)); return words[y * words_per_row + x / WordBits]; }
+    const Word& get_word(int x, int y) const { T3D_ASSERT(contains(x, y)); return words[y * words_per_row + x / WordBits]; }
+
+    int _width = 0;
+    int _height = 0;
+    int words_per_row = 0;
+    std::vector<Word> words;
+};
+
+inline int BitPlane::find_lowest_bit(Word word)
+{
+    T3D_ASSERT(word != 0);
+#if WIN32
+    // Only the 32 bit scan is available on every target
+    unsigned long index = 0;
+    if (_BitScanForward(&index, static_cast<unsigned long>(word)))
+    {
+        return static_cast<int>(index);
+    }
+    _BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+template<typename CallbackType>
+void BitPlane::for_each_set(const Window& window, CallbackType callback) const
+{
+    const Window clipped = clip(window);
+    if (clipped.empty()) { return; }
+
+    for (int y = clipped.first_row; y <= clipped.last_row; ++y)
+    {
+        const Word* row = &words[y * words_per_row];
+        for (int word_index = clipped.first_word; word_index <= clipped.last_word; ++word_index)
+        {
+            for (Word word = row[word_index]; word; word &= word - 1) // Drop lowest set bit
+            {
+                callback(word_index * WordBits + find_lowest_bit(word), y);
+            }
+        }
+    }
+}
@@ -23,7 +23,8 @@ public:
     Aspect and_without();
 
     bool is_match(const detail::ComponentMask& mask) const;
-    detail::ComponentID get_primary_component_id() { return primary_component; }
+    detail::ComponentID get_primary_component_id() const { return primary_component; }
+    const detail::ComponentMask& get_required_components() const { return required_components; }
 
 private:
     detail::ComponentID primary_component = 0;
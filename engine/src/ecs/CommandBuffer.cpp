@@ -0,0 +1,118 @@
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+namespace ecs
+{
+
+EntityID CommandBuffer::create_entity()
+{
+    // The reserved version never belongs to a live entity, so provisional ids cannot be mistaken for real ones
+    return EntityID(provisional_count++, EntityID::ReservedVersion);
+}
+
+void CommandBuffer::destroy_entity(const EntityID& entity)
+{
+    destroyed_entities.push_back(entity);
+}
+
+bool CommandBuffer::empty() const
+{
+    return provisional_count == 0 && destroyed_entities.empty() && pending_removes.none() && pending_adds.none();
+}
+
+void CommandBuffer::apply(ECS& entities)
+{
+    T3D_ASSERT(created_entities.empty());
+    created_entities.reserve(provisional_count);
+    for (std::size_t index = 0; index < provisional_count; ++index)
+    {
+        created_entities.push_back(entities.create_entity().entity_id());
+    }
+
+    for (detail::ComponentID id = 0; id < detail::MaxComponentCount; ++id)
+    {
+        if (!pending_removes[id]) { continue; }
+
+        for (const auto& recorded_entity : removed_components[id])
+        {
+            EntityID entity = resolve(recorded_entity);
+            if (!entities.contains(entity) || !entities.has_component_unsafe(entity, id)) { continue; }
+
+            removed_masks.emplace_back(entity, entities.component_masks[entity.index()]);
+            entities.detach_component(entity, id);
+        }
+    }
+
+    for (detail::ComponentID id = 0; id < detail::MaxComponentCount; ++id)
+    {
+        if (pending_adds[id])
+        {
+            added_components[id]->apply(entities, *this);
+        }
+    }
+
+    fire_events(entities);
+
+    for (const auto& recorded_entity : destroyed_entities)
+    {
+        EntityID entity = resolve(recorded_entity);
+        if (entities.contains(entity))
+        {
+            entities.destroy_entity(entity);
+        }
+    }
+
+    clear();
+}
+
+void CommandBuffer::clear()
+{
+    provisional_count = 0;
+    created_entities.clear();
+    destroyed_entities.clear();
+    for (detail::ComponentID id = 0; id < detail::MaxComponentCount; ++id)
+    {
+        if (pending_removes[id]) { removed_components[id].clear(); }
+        if (pending_adds[id]) { added_components[id]->clear(); }
+    }
+    pending_removes.reset();
+    pending_adds.reset();
+    removed_masks.clear();
+    added_entities.clear();
+}
+
+EntityID CommandBuffer::resolve(const EntityID& entity) const
+{
+    if (entity.version() != EntityID::ReservedVersion) { return entity; }
+
+    T3D_ASSERT(entity.index() < created_entities.size()); // Provisional id from another buffer
+    return entity.index() < created_entities.size() ? created_entities[entity.index()] : NullEntityID;
+}
+
+void CommandBuffer::fire_events(ECS& entities)
+{
+    auto by_index = [](const EntityID& lhs, const EntityID& rhs) { return lhs.index() < rhs.index(); };
+
+    // Keep the first recorded mask per entity, which is the mask from before the batch
+    std::stable_sort(removed_masks.begin(), removed_masks.end(), [&by_index](const std::pair<EntityID, detail::ComponentMask>& lhs, const std::pair<EntityID, detail::ComponentMask>& rhs)
+    {
+        return by_index(lhs.first, rhs.first);
+    });
+    for (std::size_t index = 0; index < removed_masks.size(); ++index)
+    {
+        if (index > 0 && removed_masks[index].first == removed_masks[index - 1].first) { continue; }
+        entities.on_component_removed_event.call({removed_masks[index].first, &entities}, removed_masks[index].second);
+    }
+
+    std::sort(added_entities.begin(), added_entities.end(), by_index);
+    added_entities.erase(std::unique(added_entities.begin(), added_entities.end()), added_entities.end());
+    for (const auto& entity : added_entities)
+    {
+        // Earlier callbacks may have destroyed or changed the entity
+        if (!entities.contains(entity)) { continue; }
+        entities.on_component_added_event.call({entity, &entities}, entities.component_masks[entity.index()]);
+    }
+}
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Component.h"
+#include "ECS.h"
+#include "EntityID.h"
+
+#include <diag/Assert.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ecs
+{
+
+// Records structural changes while iterating views, to be applied afterwards in a single pass.
+// Entities created through the buffer get a provisional id that is only valid for commands recorded in the same
+// buffer. Applying runs creates, removes, adds and destroys in that order, each grouped per pool.
+// Component events fire once per touched entity: removals with the mask from before the batch, additions with the
+// mask after the batch.
+class CommandBuffer
+{
+public:
+    CommandBuffer() = default;
+    CommandBuffer(CommandBuffer&&) = default;
+    CommandBuffer& operator=(CommandBuffer&&) = default;
+
+    EntityID create_entity();
+    void destroy_entity(const EntityID& entity);
+
+    template<typename ComponentType, typename ...Args>
+    void add_component(const EntityID& entity, Args&& ...args);
+    template<typename ComponentType>
+    void remove_component(const EntityID& entity);
+
+    bool empty() const;
+    void apply(ECS& entities);
+    void clear();
+
+private:
+    struct BasePendingAdds
+    {
+        virtual ~BasePendingAdds() = default;
+        virtual void apply(ECS& entities, CommandBuffer& buffer) = 0;
+        virtual void clear() = 0;
+    };
+
+    template<typename ComponentType>
+    struct PendingAdds : public BasePendingAdds
+    {
+        virtual void apply(ECS& entities, CommandBuffer& buffer) override { buffer.apply_adds(entities, *this); }
+        virtual void clear() override { items.clear(); }
+
+        std::vector<std::pair<EntityID, ComponentType>> items;
+    };
+
+    template<typename ComponentType>
+    void apply_adds(ECS& entities, PendingAdds<ComponentType>& pending);
+    EntityID resolve(const EntityID& entity) const;
+    void fire_events(ECS& entities);
+
+    std::size_t provisional_count = 0;
+    std::vector<EntityID> created_entities;
+    std::vector<EntityID> destroyed_entities;
+    std::vector<EntityID> removed_components[detail::MaxComponentCount];
+    std::unique_ptr<BasePendingAdds> added_components[detail::MaxComponentCount];
+    detail::ComponentMask pending_removes;
+    detail::ComponentMask pending_adds;
+
+    // Touched entities of the batch being applied, used to fire a single event per entity
+    std::vector<std::pair<EntityID, detail::ComponentMask>> removed_masks;
+    std::vector<EntityID> added_entities;
+};
+
+template<typename ComponentType, typename ...Args>
+void CommandBuffer::add_component(const EntityID& entity, Args&& ...args)
+{
+    auto component_id = detail::get_component_id<ComponentType>();
+    auto& pending = added_components[component_id];
+    if (!pending)
+    {
+        pending.reset(new PendingAdds<ComponentType>());
+    }
+    auto& items = static_cast<PendingAdds<ComponentType>&>(*pending).items;
+    items.emplace_back(entity, ComponentType(std::forward<Args>(args)...));
+    pending_adds.set(component_id);
+}
+
+template<typename ComponentType>
+inline void CommandBuffer::remove_component(const EntityID& entity)
+{
+    auto component_id = detail::get_component_id<ComponentType>();
+    removed_components[component_id].push_back(entity);
+    pending_removes.set(component_id);
+}
+
+template<typename ComponentType>
+void CommandBuffer::apply_adds(ECS& entities, PendingAdds<ComponentType>& pending)
+{
+    auto component_id = detail::get_component_id<ComponentType>();
+    auto& pool = entities.get_or_create_pool<ComponentType>(component_id);
+    pool.reserve(pool.size() + pending.items.size());
+    for (auto& item : pending.items)
+    {
+        EntityID entity = resolve(item.first);
+        if (!entities.contains(entity)) { continue; } // Destroyed before the buffer got applied
+
+        pool.add(entity, std::move(item.second));
+        entities.component_masks[entity.index()].set(component_id, true);
+        added_entities.push_back(entity);
+    }
+}
+
+}
@@ -6,48 +6,186 @@
 #include <ds/ArrayView.h>
 
 #include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 namespace ecs
 {
 
-class ComponentPool
+// Type-erased part of a component pool: maps entities to their slot in the dense component array
+class BaseComponentPool
 {
-    // Use memory type that will align properly for all possible types
-    using StorageType = std::max_align_t;
+protected:
+    using DenseIndex = unsigned;
 
-public:
-    ComponentPool() = default;
-    ComponentPool(std::size_t component_size) { init(component_size); }
+    // Sparse lookup is split into pages so entity ranges without this component do not cost any memory
+    static const std::size_t SparsePageSize = 1024;
+    static const DenseIndex InvalidDenseIndex = static_cast<DenseIndex>(-1);
 
-    void init(std::size_t new_component_size);
+public:
+    virtual ~BaseComponentPool() = default;
 
     void* get(const EntityID& entity);
-    void* add(const EntityID& entity);
-    void remove(const EntityID& entity);
+    void* get_at(std::size_t component_index) { T3D_ASSERT(component_index < data_owners.size()); return get_component_memory(component_index); }
+    virtual void remove(const EntityID& entity) = 0;
 
+    std::size_t size() const { return data_owners.size(); }
     ArrayView<const EntityID> get_owners() const { return {data_owners.data(), data_owners.size()}; }
 
+protected:
+    explicit BaseComponentPool(std::size_t component_size) : component_size(component_size) {}
+
+    void* get_component_memory(std::size_t component_index) { return component_memory + component_index * component_size; }
+    DenseIndex find_dense_index(const EntityID& entity) const;
+    DenseIndex add_owner(const EntityID& entity);
+    void remove_owner(DenseIndex data_index);
+
+    unsigned char* component_memory = nullptr; // Owned by the typed pool
+
 private:
-    std::size_t get_component_offset(std::size_t component_index) const { return component_index * component_memory_blocks; }
-    void* get_component_memory(std::size_t component_index) { return pool.data() + get_component_offset(component_index); }
-    void update_pool_size(std::size_t new_component_count);
+    DenseIndex& get_sparse_entry(const EntityID& entity);
 
     std::size_t component_size = 0;
-    std::size_t component_memory_size = 0;
-    std::size_t component_memory_blocks = 0;
-    std::size_t component_count = 0;
-
-    std::unordered_map<EntityID, std::size_t> handles;
+    std::vector<std::vector<DenseIndex>> sparse_pages; // EntityID::index -> index into data_owners/component_memory
     std::vector<EntityID> data_owners;
-    std::vector<StorageType> pool;
 };
 
-inline void ComponentPool::update_pool_size(std::size_t new_component_count)
+// Densely packed storage for a single component type.
+// Components are relocated with memcpy when the type allows it, otherwise they are move constructed and destroyed.
+template<typename ComponentType>
+class ComponentPool : public BaseComponentPool
+{
+    using StorageType = typename std::aligned_storage<sizeof(ComponentType), alignof(ComponentType)>::type;
+    using IsTriviallyCopyable = std::integral_constant<bool, std::is_trivially_copyable<ComponentType>::value>;
+
+public:
+    ComponentPool() : BaseComponentPool(sizeof(StorageType)) {}
+    ComponentPool(const ComponentPool&) = delete;
+    ComponentPool& operator=(const ComponentPool&) = delete;
+    virtual ~ComponentPool() override;
+
+    template<typename ...Args>
+    ComponentType* add(const EntityID& entity, Args&& ...args);
+    virtual void remove(const EntityID& entity) override;
+    void reserve(std::size_t new_capacity);
+
+private:
+    ComponentType* at(std::size_t component_index) { return reinterpret_cast<ComponentType*>(storage.get() + component_index); }
+
+    static void relocate(ComponentType* destination, ComponentType* source, std::size_t count, std::true_type);
+    static void relocate(ComponentType* destination, ComponentType* source, std::size_t count, std::false_type);
+
+    std::unique_ptr<StorageType[]> storage;
+    std::size_t capacity = 0;
+};
+
+inline BaseComponentPool::DenseIndex BaseComponentPool::find_dense_index(const EntityID& entity) const
+{
+    const std::size_t page_index = entity.index() / SparsePageSize;
+    if (page_index >= sparse_pages.size() || sparse_pages[page_index].empty())
+    {
+        return InvalidDenseIndex;
+    }
+
+    const DenseIndex dense_index = sparse_pages[page_index][entity.index() % SparsePageSize];
+    // Owner check also rejects stale handles that share the index but not the version
+    if (dense_index == InvalidDenseIndex || data_owners[dense_index] != entity)
+    {
+        return InvalidDenseIndex;
+    }
+    return dense_index;
+}
+
+inline void* BaseComponentPool::get(const EntityID& entity)
+{
+    const DenseIndex dense_index = find_dense_index(entity);
+    return dense_index != InvalidDenseIndex ? get_component_memory(dense_index) : nullptr;
+}
+
+template<typename ComponentType>
+ComponentPool<ComponentType>::~ComponentPool()
+{
+    for (std::size_t component_index = 0; component_index < size(); ++component_index)
+    {
+        at(component_index)->~ComponentType();
+    }
+}
+
+template<typename ComponentType>
+template<typename ...Args>
+ComponentType* ComponentPool<ComponentType>::add(const EntityID& entity, Args&& ...args)
+{
+    if (find_dense_index(entity) != InvalidDenseIndex)
+    {
+        T3D_FAIL("Component already present");
+        return static_cast<ComponentType*>(get(entity));
+    }
+
+    if (size() == capacity)
+    {
+        reserve(capacity ? capacity * 2 : 4);
+    }
+
+    ComponentType* component = new (at(size())) ComponentType(std::forward<Args>(args)...);
+    add_owner(entity);
+    return component;
+}
+
+template<typename ComponentType>
+void ComponentPool<ComponentType>::remove(const EntityID& entity)
+{
+    const DenseIndex data_index = find_dense_index(entity);
+    if (data_index == InvalidDenseIndex)
+    {
+        T3D_FAIL("Double free");
+        return;
+    }
+
+    // Move last component into the removed component location
+    ComponentType* removed_component = at(data_index);
+    removed_component->~ComponentType();
+    const std::size_t last_index = size() - 1;
+    if (data_index != last_index)
+    {
+        relocate(removed_component, at(last_index), 1, IsTriviallyCopyable());
+    }
+
+    remove_owner(data_index);
+}
+
+template<typename ComponentType>
+void ComponentPool<ComponentType>::reserve(std::size_t new_capacity)
+{
+    if (new_capacity <= capacity) { return; }
+
+    std::unique_ptr<StorageType[]> new_storage(new StorageType[new_capacity]);
+    if (storage)
+    {
+        relocate(reinterpret_cast<ComponentType*>(new_storage.get()), at(0), size(), IsTriviallyCopyable());
+    }
+    storage = std::move(new_storage);
+    capacity = new_capacity;
+    component_memory = reinterpret_cast<unsigned char*>(storage.get());
+}
+
+template<typename ComponentType>
+inline void ComponentPool<ComponentType>::relocate(ComponentType* destination, ComponentType* source, std::size_t count, std::true_type)
+{
+    memcpy(destination, source, count * sizeof(ComponentType));
+}
+
+template<typename ComponentType>
+inline void ComponentPool<ComponentType>::relocate(ComponentType* destination, ComponentType* source, std::size_t count, std::false_type)
 {
-    component_count = new_component_count;
-    pool.resize(component_count * component_memory_blocks);
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        new (destination + index) ComponentType(std::move(source[index]));
+        source[index].~ComponentType();
+    }
 }
 
 }
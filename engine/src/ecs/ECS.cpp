@@ -40,15 +40,17 @@ EntityFacade ECS::create_entity()
 
     if (first_free == entities.size())
     {
-        entities.push_back(EntityID());
-        entities.back().index = entities.size();
-        entities.back().version = 0;
+        T3D_ASSERT(entities.size() < EntityID::MaxIndex); // Out of entity indices
+        entities.push_back(EntitySlot());
+        entities.back().entity_id = EntityID(entities.size(), 0);
         component_masks.push_back(0);
     }
 
     T3D_ASSERT(!component_masks[first_free].any()); // Should not have any registered components
-    auto& entity = entities[first_free];
-    std::swap(entity.index, first_free);
+    auto& entity = entities[first_free].entity_id;
+    std::size_t next_free = entity.index();
+    entity = EntityID(first_free, entity.version());
+    first_free = next_free;
 
     return EntityFacade(entity, this);
 }
@@ -61,32 +63,36 @@ void ECS::destroy_entity(const EntityID& entity)
         return;
     }
 
-    destroyed_entities.insert(entity);
+    entities[entity.index()].destroyed = true;
+    pending_destroys.push_back(entity);
 }
 
 void ECS::cleanup_entities()
 {
-    for (auto& entity : destroyed_entities)
+    // Removal callbacks may destroy more entities, so the list can grow while iterating
+    for (std::size_t pending_index = 0; pending_index < pending_destroys.size(); ++pending_index)
     {
+        EntityID entity = pending_destroys[pending_index];
         cleanup_entity(entity);
     }
-    destroyed_entities.clear();
+    pending_destroys.clear();
 }
 
 void ECS::cleanup_entity(const EntityID& entity)
 {
-    auto& stored_entity = entities[entity.index];
-    if (entity == stored_entity)
+    auto& slot = entities[entity.index()];
+    if (entity == slot.entity_id)
     {
         destroy_components(entity);
-        ++stored_entity.version;
-        std::swap(stored_entity.index, first_free);
+        slot.destroyed = false;
+        slot.entity_id = EntityID(first_free, entity.next_version());
+        first_free = entity.index();
     }
 }
 
 void ECS::destroy_components(const EntityID& entity)
 {
-    auto old_mask = component_masks[entity.index];
+    auto old_mask = component_masks[entity.index()];
     for (detail::ComponentID id = 0; id < detail::MaxComponentCount; ++id)
     {
         if (!old_mask[id])
@@ -94,10 +100,10 @@ void ECS::destroy_components(const EntityID& entity)
             continue;
         }
 
-        T3D_ASSERT(active_components[id]); // Got component without any pool
-        components[id].remove(entity);
+        T3D_ASSERT(components[id]); // Got component without any pool
+        components[id]->remove(entity);
     }
-    component_masks[entity.index].reset();
+    component_masks[entity.index()].reset();
 
     // Trigger callbacks based on old mask to enable detecting the component being removed
     on_component_removed_event.call({entity, this}, old_mask);
@@ -105,25 +111,16 @@ void ECS::destroy_components(const EntityID& entity)
 
 void* ECS::get_component_by_id(const EntityID& entity, detail::ComponentID id) const
 {
-    if(!active_components[id]) { return nullptr; }
+    if(!components[id]) { return nullptr; }
 
     // We allow returning mutable memory so this method can be used by both const and non-const instances
-    const auto& pool = components[id];
-    return const_cast<ComponentPool&>(pool).get(entity);
+    return components[id]->get(entity);
 }
 
-void* ECS::add_component_by_id(const EntityID& entity, detail::ComponentID id, std::size_t size)
+void ECS::on_component_added(const EntityID& entity, detail::ComponentID id)
 {
-    auto& pool_location = components[id];
-    if (!active_components[id])
-    {
-        active_components[id] = true;
-        pool_location.init(size);
-    }
-
-    component_masks[entity.index].set(id, true);
-    on_component_added_event.call(EntityFacade(entity, this), component_masks[entity.index]);
-    return pool_location.add(entity);
+    component_masks[entity.index()].set(id, true);
+    on_component_added_event.call(EntityFacade(entity, this), component_masks[entity.index()]);
 }
 
 bool ECS::try_remove_component(const EntityID& entity, detail::ComponentID id)
@@ -143,74 +140,66 @@ void ECS::remove_component(const EntityID& entity, detail::ComponentID id)
 {
     if (!contains(entity)) { return; }
 
-    T3D_ASSERT(active_components[id]); // Got component without any pool
-    components[id].remove(entity);
-    auto old_mask = component_masks[entity.index];
-    component_masks[entity.index].set(id, false);
+    auto old_mask = component_masks[entity.index()];
+    T3D_ASSERT(old_mask[id]); // Component should be present
+    detach_component(entity, id);
 
     // Trigger callbacks based on old mask to enable detecting the component being removed
     on_component_removed_event.call({entity, this}, old_mask);
 }
 
+// Removes the component without triggering callbacks
+bool ECS::detach_component(const EntityID& entity, detail::ComponentID id)
+{
+    if (!contains(entity) || !has_component_unsafe(entity, id)) { return false; }
+
+    T3D_ASSERT(components[id]); // Got component without any pool
+    components[id]->remove(entity);
+    component_masks[entity.index()].set(id, false);
+    return true;
+}
+
 EntityFacade ECS::find_first(const Aspect& aspect)
 {
     EntityFacade found;
-    for (std::size_t entity_index = 0; entity_index < component_masks.size(); ++entity_index)
+    for_each_match(aspect, [this, &found](const EntityID& entity_id)
     {
-        const auto& mask = component_masks[entity_index];
-        if (aspect.is_match(mask))
-        {
-            const auto& entity_id = entities[entity_index];
-            found = get_facade(entity_id);
-        }
-    }
+        found = get_facade(entity_id);
+        return false;
+    });
     return found;
 }
 
 ReadOnlyEntityFacade ECS::find_first(const Aspect& aspect) const
 {
     ReadOnlyEntityFacade found;
-    for (std::size_t entity_index = 0; entity_index < component_masks.size(); ++entity_index)
+    for_each_match(aspect, [this, &found](const EntityID& entity_id)
     {
-        const auto& mask = component_masks[entity_index];
-        if (aspect.is_match(mask))
-        {
-            const auto& entity_id = entities[entity_index];
-            found = get_facade(entity_id);
-        }
-    }
+        found = get_facade(entity_id);
+        return false;
+    });
     return found;
 }
 
 std::vector<EntityFacade> ECS::find_all(const Aspect& aspect)
 {
     std::vector<EntityFacade> found;
-    for (std::size_t entity_index = 0; entity_index < component_masks.size(); ++entity_index)
+    for_each_match(aspect, [this, &found](const EntityID& entity_id)
     {
-        const auto& mask = component_masks[entity_index];
-        if (!aspect.is_match(mask)) { continue; }
-
-        const auto& entity_id = entities[entity_index];
-        if (is_destroyed(entity_id)) { continue; }
-
         found.emplace_back(get_facade(entity_id));
-    }
+        return true;
+    });
     return found;
 }
 
 std::vector<ReadOnlyEntityFacade> ECS::find_all(const Aspect& aspect) const
 {
     std::vector<ReadOnlyEntityFacade> found;
-    for (std::size_t entity_index = 0; entity_index < component_masks.size(); ++entity_index)
+    for_each_match(aspect, [this, &found](const EntityID& entity_id)
     {
-        const auto& mask = component_masks[entity_index];
-        if (!aspect.is_match(mask)) { continue; }
-
-        const auto& entity_id = entities[entity_index];
-        if (is_destroyed(entity_id)) { continue; }
-
         found.emplace_back(get_facade(entity_id));
-    }
+        return true;
+    });
     return found;
 }
 
@@ -4,17 +4,19 @@
 #include "EntityID.h"
 #include "Component.h"
 #include "ComponentPool.h"
+#include "View.h"
 
 #include <diag/Assert.h>
 
+#include <memory>
 #include <vector>
 #include <tuple>
-#include <set>
 
 namespace ecs
 {
 
 class ECS;
+class CommandBuffer;
 
 class ReadOnlyEntityFacade
 {
@@ -78,6 +80,12 @@ private:
 };
 
 static const EntityFacade NullEntity = EntityFacade();
+
+template<typename ...ComponentType>
+using View = BasicView<ECS, EntityFacade, ComponentType...>;
+template<typename ...ComponentType>
+using ReadOnlyView = BasicView<const ECS, ReadOnlyEntityFacade, const ComponentType...>;
+
 using EntityEventCallback = std::function<void(ecs::EntityFacade)>;
 
 struct EntityEventCallbackList
@@ -104,6 +112,8 @@ public:
     EntityFacade create_entity();
     void destroy_entity(const EntityID& entity);
     void cleanup_entities();
+    // False once destroyed, even while the entity still awaits cleanup
+    bool is_alive(const EntityID& entity) const { return contains(entity); }
 
     template<typename ComponentType, typename ...Args>
     ComponentType* add_component(const EntityID& entity, Args&& ...args);
@@ -124,6 +134,10 @@ public:
     template<typename ...ComponentType>
     std::tuple<const ComponentType*...> get_components(const EntityID& entity) const;
 
+    // Queries visit matches in the dense order of the smallest required pool, not in entity index order.
+    // A pool is in insertion order until a removal moves its last entry into the freed slot, so the order is
+    // deterministic for a given sequence of changes. Only aspects without required components go by entity index.
+    // find_first returns the first match in that order.
     std::vector<EntityFacade> find_all(const Aspect& aspect);
     std::vector<ReadOnlyEntityFacade> find_all(const Aspect& aspect) const;
 
@@ -139,43 +153,121 @@ public:
     template<typename ...ComponentType>
     ReadOnlyEntityFacade find_first() const;
 
+    template<typename ...ComponentType>
+    View<ComponentType...> view();
+    template<typename ...ComponentType>
+    ReadOnlyView<ComponentType...> view() const;
+
     EntityEventCallbackList on_component_added_event;
     EntityEventCallbackList on_component_removed_event;
 
 private:
+    template<typename ECSType, typename FacadeType, typename ...ComponentType>
+    friend class BasicView;
+    friend class CommandBuffer;
+
+    template<typename CallbackType>
+    void for_each_match(const Aspect& aspect, CallbackType callback) const;
+    bool plan_query(const detail::ComponentMask& required_components, detail::ComponentID* pool_id) const;
+
     void cleanup_entity(const EntityID& entity);
     bool contains(const EntityID& entity) const;
     bool has_component_unsafe(const EntityID& entity, detail::ComponentID id) const;
     bool is_destroyed(const EntityID& entity) const;
     void destroy_components(const EntityID& entity);
     void* get_component_by_id(const EntityID& entity, detail::ComponentID id) const;
-    void* add_component_by_id(const EntityID& entity, detail::ComponentID id, std::size_t size);
+    template<typename ComponentType>
+    ComponentPool<ComponentType>& get_or_create_pool(detail::ComponentID id);
+    void on_component_added(const EntityID& entity, detail::ComponentID id);
     void remove_component(const EntityID& entity, detail::ComponentID id);
     bool try_remove_component(const EntityID& entity, detail::ComponentID id);
+    bool detach_component(const EntityID& entity, detail::ComponentID id);
     EntityFacade get_facade(const EntityID& entity);
     ReadOnlyEntityFacade get_facade(const EntityID& entity) const;
 
+    struct EntitySlot
+    {
+        EntityID entity_id; // Links to the next free slot through its index while unused
+        bool destroyed = false; // Destroyed but not yet cleaned up
+    };
+
     std::size_t first_free = 0;
-    std::vector<EntityID> entities;
-    std::set<EntityID> destroyed_entities;
+    std::vector<EntitySlot> entities;
+    std::vector<EntityID> pending_destroys;
     std::vector<detail::ComponentMask> component_masks;
-    bool active_components[detail::MaxComponentCount];
-    ComponentPool components[detail::MaxComponentCount];
+    std::unique_ptr<BaseComponentPool> components[detail::MaxComponentCount];
 };
 
 inline bool ECS::contains(const EntityID& entity) const
 {
-    return entity.index < entities.size() && entities[entity.index] == entity && !is_destroyed(entity);
+    if (entity.index() >= entities.size()) { return false; }
+
+    const auto& slot = entities[entity.index()];
+    return slot.entity_id == entity && !slot.destroyed;
 }
 
 inline bool ECS::has_component_unsafe(const EntityID& entity, detail::ComponentID id) const
 {
-    return component_masks[entity.index][id];
+    return component_masks[entity.index()][id];
 }
 
 inline bool ECS::is_destroyed(const EntityID& entity) const
 {
-    return destroyed_entities.find(entity) != end(destroyed_entities);
+    // Skips the slot read during iteration while nothing is pending
+    return !pending_destroys.empty() && entities[entity.index()].destroyed;
+}
+
+// Picks the smallest pool among the required components. pool_id comes in holding the primary component,
+// which wins ties, other ties go to the lowest component id.
+// Returns false when nothing is required and every entity has to be considered.
+inline bool ECS::plan_query(const detail::ComponentMask& required_components, detail::ComponentID* pool_id) const
+{
+    const detail::ComponentID primary_id = *pool_id;
+    bool found = false;
+    std::size_t smallest_size = 0;
+    for (detail::ComponentID id = 0; id < detail::MaxComponentCount; ++id)
+    {
+        if (!required_components[id]) { continue; }
+
+        // Inactive pools have no entries, so nothing can match the query
+        std::size_t pool_size = components[id] ? components[id]->size() : 0;
+        if (!found || pool_size < smallest_size || (pool_size == smallest_size && id == primary_id))
+        {
+            found = true;
+            smallest_size = pool_size;
+            *pool_id = id;
+        }
+    }
+    return found;
+}
+
+// Calls callback for every live entity matching aspect in query order (see find_all), until the callback returns false
+template<typename CallbackType>
+void ECS::for_each_match(const Aspect& aspect, CallbackType callback) const
+{
+    detail::ComponentID pool_id = aspect.get_primary_component_id();
+    if (plan_query(aspect.get_required_components(), &pool_id))
+    {
+        if (!components[pool_id]) { return; }
+
+        auto owners = components[pool_id]->get_owners();
+        for (std::size_t owner_index = 0; owner_index < owners.get_size(); ++owner_index)
+        {
+            const auto& entity_id = owners[owner_index];
+            if (!aspect.is_match(component_masks[entity_id.index()]) || is_destroyed(entity_id)) { continue; }
+            if (!callback(entity_id)) { return; }
+        }
+    }
+    else
+    {
+        for (std::size_t entity_index = 0; entity_index < component_masks.size(); ++entity_index)
+        {
+            const auto& entity_id = entities[entity_index].entity_id;
+            if (entity_id.index() != entity_index) { continue; } // Free slot
+            if (!aspect.is_match(component_masks[entity_index]) || is_destroyed(entity_id)) { continue; }
+            if (!callback(entity_id)) { return; }
+        }
+    }
 }
 
 template<typename ComponentType, typename ...Args>
@@ -183,26 +275,35 @@ ComponentType* ECS::add_component(const EntityID& entity, Args&& ...args)
 {
     T3D_ASSERT(contains(entity));
     auto component_id = detail::get_component_id<ComponentType>();
-    void* storage = add_component_by_id(entity, component_id, sizeof(ComponentType));
-    return new (storage) ComponentType(std::forward<Args>(args)...);
+    auto* component = get_or_create_pool<ComponentType>(component_id).add(entity, std::forward<Args>(args)...);
+    on_component_added(entity, component_id);
+    return component;
 }
 
 template<typename ComponentType, typename ...Args>
 ComponentType* ECS::ensure_component(const EntityID& entity, Args&& ...args)
 {
     T3D_ASSERT(contains(entity));
-    void* component = nullptr;
     auto component_id = detail::get_component_id<ComponentType>();
     if (has_component_unsafe(entity, component_id))
     {
-        component = get_component_by_id(entity, component_id);
+        return static_cast<ComponentType*>(get_component_by_id(entity, component_id));
     }
     else
     {
-        component = add_component_by_id(entity, component_id, sizeof(ComponentType));
-        new (component) ComponentType(std::forward<Args>(args)...);
+        return add_component<ComponentType>(entity, std::forward<Args>(args)...);
+    }
+}
+
+template<typename ComponentType>
+inline ComponentPool<ComponentType>& ECS::get_or_create_pool(detail::ComponentID id)
+{
+    auto& pool = components[id];
+    if (!pool)
+    {
+        pool.reset(new ComponentPool<ComponentType>());
     }
-    return static_cast<ComponentType*>(component);
+    return static_cast<ComponentPool<ComponentType>&>(*pool);
 }
 
 template<typename ComponentType>
@@ -276,6 +377,18 @@ inline ReadOnlyEntityFacade ECS::find_first() const
     return find_first(Aspect::all_with<ComponentType...>());
 }
 
+template<typename ...ComponentType>
+inline View<ComponentType...> ECS::view()
+{
+    return View<ComponentType...>(this);
+}
+
+template<typename ...ComponentType>
+inline ReadOnlyView<ComponentType...> ECS::view() const
+{
+    return ReadOnlyView<ComponentType...>(this);
+}
+
 inline EntityFacade ECS::get_facade(const EntityID& entity)
 {
     return EntityFacade(entity, this);
@@ -1,33 +1,69 @@
 #pragma once
 
+#include <diag/Assert.h>
+
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 
+// Packs entity handles into 32 bits (22 bit index, 10 bit version), otherwise into 64 bits (32 bit index and version)
+#ifndef ECS_COMPACT_ENTITY_ID
+#define ECS_COMPACT_ENTITY_ID 1
+#endif
+
 namespace ecs
 {
 
-struct EntityID
+// Entity handle packed into a single integer, the version is bumped every time the index gets reused.
+// The highest version is reserved for handles that do not point to a live entity.
+class EntityID
 {
+public:
+#if ECS_COMPACT_ENTITY_ID
+    using ValueType = std::uint32_t;
+    static const unsigned IndexBits = 22;
+#else
+    using ValueType = std::uint64_t;
+    static const unsigned IndexBits = 32;
+#endif
+    static const unsigned VersionBits = sizeof(ValueType) * 8 - IndexBits;
+    static const ValueType MaxIndex = (ValueType(1) << IndexBits) - 1;
+    static const ValueType ReservedVersion = (ValueType(1) << VersionBits) - 1;
+
     EntityID() = default;
-    explicit EntityID(std::size_t index) : index(index) {}
-    EntityID(std::size_t index, unsigned version) : index(index), version(version) {}
+    EntityID(std::size_t index, unsigned version) : _value(pack(index, version)) {}
+
+    std::size_t index() const { return static_cast<std::size_t>(_value & MaxIndex); }
+    unsigned version() const { return static_cast<unsigned>(_value >> IndexBits); }
+    ValueType value() const { return _value; }
+
+    // Version for the next entity that reuses this index
+    unsigned next_version() const { return (version() + 1) % ReservedVersion; }
 
-    operator bool() const { return version != static_cast<unsigned>(-1); }
+    operator bool() const { return _value != NullValue; }
+
+private:
+    static const ValueType NullValue = static_cast<ValueType>(-1);
+
+    static ValueType pack(std::size_t index, unsigned version)
+    {
+        T3D_ASSERT(index <= MaxIndex && version <= ReservedVersion);
+        return static_cast<ValueType>(index) | (static_cast<ValueType>(version) << IndexBits);
+    }
 
-    std::size_t index = 0;
-    unsigned version = static_cast<unsigned>(-1);
+    ValueType _value = NullValue;
 };
 
 static const EntityID NullEntityID = EntityID();
 
 inline bool operator==(const EntityID& lhs, const EntityID& rhs)
 {
-    return lhs.index == rhs.index && lhs.version == rhs.version;
+    return lhs.value() == rhs.value();
 }
 
 inline bool operator!=(const EntityID& lhs, const EntityID& rhs)
 {
-    return (lhs == rhs) == false;
+    return lhs.value() != rhs.value();
 }
 
 }
@@ -42,9 +78,7 @@ template<> struct hash<ecs::EntityID>
     typedef std::size_t result_type;
     result_type operator()(argument_type const& entity) const noexcept
     {
-        result_type const h1 ( std::hash<std::size_t>{}(entity.index) );
-        result_type const h2 ( std::hash<unsigned>{}(entity.version) );
-        return h1 ^ (h2 << 1); // or use boost::hash_combine (see Discussion)
+        return std::hash<ecs::EntityID::ValueType>{}(entity.value());
     }
 };
 
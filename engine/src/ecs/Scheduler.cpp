@@ -0,0 +1,65 @@
+#include "Scheduler.h"
+
+#include <os/WorkerPool.h>
+
+#include <utility>
+
+namespace ecs
+{
+
+bool SystemAccess::conflicts_with(const SystemAccess& other) const
+{
+    if (is_exclusive || other.is_exclusive) { return true; }
+
+    return (writes & (other.reads | other.writes)).any() || (reads & other.writes).any();
+}
+
+void Scheduler::add(const SystemAccess& access, SystemFunc system)
+{
+    T3D_ASSERT(system);
+
+    std::size_t stage = 0;
+    for (const auto& previous : systems)
+    {
+        if (previous.stage >= stage && access.conflicts_with(previous.access))
+        {
+            stage = previous.stage + 1;
+        }
+    }
+
+    if (stage == stages.size())
+    {
+        stages.emplace_back();
+    }
+    stages[stage].push_back(systems.size());
+    systems.push_back({access, std::move(system), stage});
+}
+
+void Scheduler::clear()
+{
+    systems.clear();
+    stages.clear();
+}
+
+void Scheduler::run(WorkerPool* workers)
+{
+    for (const auto& stage : stages)
+    {
+        if (!workers || stage.size() == 1)
+        {
+            for (std::size_t system_index : stage)
+            {
+                systems[system_index].function();
+            }
+            continue;
+        }
+
+        for (std::size_t system_index : stage)
+        {
+            workers->submit(systems[system_index].function);
+        }
+        workers->wait();
+    }
+}
+
+}
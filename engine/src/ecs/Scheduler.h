@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Component.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+class WorkerPool;
+
+namespace ecs
+{
+
+// Components a system reads and writes, used to decide which systems can run at the same time
+class SystemAccess
+{
+public:
+    template<typename ...ComponentType>
+    SystemAccess& read() { reads |= detail::get_mask<ComponentType...>(); return *this; }
+    template<typename ...ComponentType>
+    SystemAccess& write() { writes |= detail::get_mask<ComponentType...>(); return *this; }
+    // For systems that add/remove components, create/destroy entities or touch state outside of the ECS
+    SystemAccess& exclusive() { is_exclusive = true; return *this; }
+
+    bool conflicts_with(const SystemAccess& other) const;
+
+private:
+    detail::ComponentMask reads;
+    detail::ComponentMask writes;
+    bool is_exclusive = false;
+};
+
+// Runs systems in stages, a system is placed in the stage after the last earlier system it conflicts with.
+// Systems within a stage run concurrently, so the results match running all systems in the order they were added
+// as long as the declared access is complete.
+class Scheduler
+{
+public:
+    using SystemFunc = std::function<void()>;
+
+    void add(const SystemAccess& access, SystemFunc system);
+    void clear();
+    bool empty() const { return systems.empty(); }
+
+    // Runs every system once, on the calling thread only when no workers are given
+    void run(WorkerPool* workers);
+
+private:
+    struct System
+    {
+        SystemAccess access;
+        SystemFunc function;
+        std::size_t stage;
+    };
+
+    std::vector<System> systems;
+    std::vector<std::vector<std::size_t>> stages; // Indices into systems, in order of addition
+};
+
+}
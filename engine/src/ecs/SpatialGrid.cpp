@@ -0,0 +1,95 @@
+#include "SpatialGrid.h"
+
+namespace ecs
+{
+
+const SpatialGrid::NodeIndex SpatialGrid::InvalidNode;
+
+void SpatialGrid::reset(int width, int height)
+{
+    T3D_ASSERT(width >= 0 && height >= 0);
+    cell_heads.resize(0, 0);
+    cell_heads.resize(width, height, InvalidNode);
+    nodes.clear();
+}
+
+void SpatialGrid::insert(const EntityID& entity, const math::Vec2i& pos)
+{
+    T3D_ASSERT(entity);
+    const std::size_t entity_index = entity.index();
+    if (entity_index >= nodes.size())
+    {
+        nodes.resize(entity_index + 1);
+    }
+
+    // A stale entity on the same index was never removed, drop it
+    if (nodes[entity_index].entity)
+    {
+        T3D_ASSERT(nodes[entity_index].entity != entity); // Already inserted
+        unlink(static_cast<NodeIndex>(entity_index));
+    }
+
+    nodes[entity_index].entity = entity;
+    link(static_cast<NodeIndex>(entity_index), get_cell(pos));
+}
+
+void SpatialGrid::move(const EntityID& entity, const math::Vec2i& pos)
+{
+    if (!contains(entity))
+    {
+        T3D_FAIL("Entity not in grid");
+        return;
+    }
+
+    const NodeIndex node_index = static_cast<NodeIndex>(entity.index());
+    const std::size_t cell = get_cell(pos);
+    if (nodes[node_index].cell == cell) { return; }
+
+    unlink(node_index);
+    link(node_index, cell);
+}
+
+void SpatialGrid::remove(const EntityID& entity)
+{
+    if (!contains(entity)) { return; }
+
+    const NodeIndex node_index = static_cast<NodeIndex>(entity.index());
+    unlink(node_index);
+    nodes[node_index].entity = NullEntityID;
+}
+
+void SpatialGrid::link(NodeIndex node_index, std::size_t cell)
+{
+    Node& node = nodes[node_index];
+    NodeIndex& head = cell_heads.at(cell);
+    node.cell = cell;
+    node.prev = InvalidNode;
+    node.next = head;
+    if (head != InvalidNode)
+    {
+        nodes[head].prev = node_index;
+    }
+    head = node_index;
+}
+
+void SpatialGrid::unlink(NodeIndex node_index)
+{
+    Node& node = nodes[node_index];
+    if (node.prev != InvalidNode)
+    {
+        nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        cell_heads.at(node.cell) = node.next;
+    }
+
+    if (node.next != InvalidNode)
+    {
+        nodes[node.next].prev = node.prev;
+    }
+    node.prev = InvalidNode;
+    node.next = InvalidNode;
+}
+
+}
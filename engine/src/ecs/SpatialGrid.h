@@ -0,0 +1,107 @@
+#pragma once
+
+#include "EntityID.h"
+
+#include <diag/Assert.h>
+#include <ds/Array2.h>
+#include <ds/Rect.h>
+#include <math/Vec2.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace ecs
+{
+
+// Buckets entities by the grid cell they are on.
+// Every cell heads a doubly linked list threaded through a node per entity index, so inserting, moving and removing
+// an entity are constant time and a cell lookup only touches the entities on that cell.
+class SpatialGrid
+{
+public:
+    void reset(int width, int height);
+
+    void insert(const EntityID& entity, const math::Vec2i& pos);
+    void move(const EntityID& entity, const math::Vec2i& pos);
+    void remove(const EntityID& entity);
+    bool contains(const EntityID& entity) const;
+
+    // Callbacks receive the EntityID and return false to stop iterating
+    template<typename CallbackType>
+    void for_each_at(const math::Vec2i& pos, CallbackType callback) const;
+    template<typename CallbackType>
+    void for_each_in(const Recti& rect, CallbackType callback) const;
+
+private:
+    using NodeIndex = unsigned;
+    static const NodeIndex InvalidNode = static_cast<NodeIndex>(-1);
+
+    struct Node
+    {
+        EntityID entity;
+        NodeIndex prev = InvalidNode;
+        NodeIndex next = InvalidNode;
+        std::size_t cell = 0;
+    };
+
+    std::size_t get_cell(const math::Vec2i& pos) const;
+    void link(NodeIndex node_index, std::size_t cell);
+    void unlink(NodeIndex node_index);
+    template<typename CallbackType>
+    bool for_each_in_cell(std::size_t cell, CallbackType& callback) const;
+
+    Array2<NodeIndex> cell_heads;
+    std::vector<Node> nodes; // Indexed by EntityID::index(), unused nodes hold NullEntityID
+};
+
+inline bool SpatialGrid::contains(const EntityID& entity) const
+{
+    return entity.index() < nodes.size() && nodes[entity.index()].entity == entity;
+}
+
+inline std::size_t SpatialGrid::get_cell(const math::Vec2i& pos) const
+{
+    T3D_ASSERT(pos.x >= 0 && pos.y >= 0); // Outside of grid
+    return cell_heads.get_index(pos.x, pos.y);
+}
+
+template<typename CallbackType>
+inline bool SpatialGrid::for_each_in_cell(std::size_t cell, CallbackType& callback) const
+{
+    NodeIndex node_index = cell_heads.at(cell);
+    while (node_index != InvalidNode)
+    {
+        // Read ahead so the callback may move or remove the current entity
+        const Node& node = nodes[node_index];
+        NodeIndex next = node.next;
+        if (!callback(node.entity)) { return false; }
+        node_index = next;
+    }
+    return true;
+}
+
+template<typename CallbackType>
+void SpatialGrid::for_each_at(const math::Vec2i& pos, CallbackType callback) const
+{
+    if (pos.x < 0 || pos.y < 0 || !cell_heads.contains(pos.x, pos.y)) { return; }
+
+    for_each_in_cell(get_cell(pos), callback);
+}
+
+template<typename CallbackType>
+void SpatialGrid::for_each_in(const Recti& rect, CallbackType callback) const
+{
+    const int left = std::max(rect.left, 0);
+    const int top = std::max(rect.top, 0);
+    const int right = std::min(rect.right, static_cast<int>(cell_heads.width()));
+    const int bottom = std::min(rect.bottom, static_cast<int>(cell_heads.height()));
+    for (int y = top; y < bottom; ++y)
+    {
+        for (int x = left; x < right; ++x)
+        {
+            if (!for_each_in_cell(cell_heads.get_index(x, y), callback)) { return; }
+        }
+    }
+}
+
+}
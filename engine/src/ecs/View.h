@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Component.h"
+#include "ComponentPool.h"
+#include "EntityID.h"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace ecs
+{
+
+namespace detail
+{
+
+template<typename Type, typename ...Types>
+struct TypeIndex;
+
+template<typename Type, typename ...Types>
+struct TypeIndex<Type, Type, Types...> : std::integral_constant<std::size_t, 0> {};
+
+template<typename Type, typename Other, typename ...Types>
+struct TypeIndex<Type, Other, Types...> : std::integral_constant<std::size_t, 1 + TypeIndex<Type, Types...>::value> {};
+
+template<typename ComponentType>
+using RawComponent = typename std::remove_const<ComponentType>::type;
+
+}
+
+// Lazily iterates all entities that have every listed component, without allocating.
+// Iteration walks the dense array of the smallest pool among the listed components, so adding or removing any of
+// the listed components while iterating invalidates the view. Changes to other components are safe.
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+class BasicView
+{
+    static_assert(sizeof...(ComponentType) > 0, "View requires at least one component type");
+
+public:
+    struct Item
+    {
+        FacadeType entity;
+        std::tuple<ComponentType*...> components;
+
+        template<typename Type>
+        auto get() const -> typename std::tuple_element<detail::TypeIndex<Type, detail::RawComponent<ComponentType>...>::value, std::tuple<ComponentType*...>>::type
+        {
+            return std::get<detail::TypeIndex<Type, detail::RawComponent<ComponentType>...>::value>(components);
+        }
+    };
+
+    class Iterator
+    {
+    public:
+        Iterator(const BasicView* view, std::size_t index) : view(view), index(index) { skip_mismatches(); }
+
+        Item operator*() const { return view->get_item(index); }
+        Iterator& operator++() { ++index; skip_mismatches(); return *this; }
+        bool operator==(const Iterator& rhs) const { return index == rhs.index; }
+        bool operator!=(const Iterator& rhs) const { return index != rhs.index; }
+
+    private:
+        void skip_mismatches()
+        {
+            while (index < view->get_size() && !view->is_match(index)) { ++index; }
+        }
+
+        const BasicView* view = nullptr;
+        std::size_t index = 0;
+    };
+
+    explicit BasicView(ECSType* entities);
+
+    template<typename ...ExcludedType>
+    BasicView without() const;
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, get_size()); }
+
+private:
+    std::size_t get_size() const { return pool ? pool->size() : 0; }
+    bool is_match(std::size_t dense_index) const;
+    Item get_item(std::size_t dense_index) const;
+
+    template<typename Type>
+    Type* get_component(const EntityID& entity, std::size_t dense_index) const;
+
+    ECSType* entities = nullptr;
+    BaseComponentPool* pool = nullptr;
+    detail::ComponentID primary_component = 0;
+    detail::ComponentMask required_components;
+    detail::ComponentMask disallowed_components;
+};
+
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+inline BasicView<ECSType, FacadeType, ComponentType...>::BasicView(ECSType* entities)
+    : entities(entities)
+{
+    auto set = detail::get_mask_and_primary<detail::RawComponent<ComponentType>...>();
+    primary_component = set.primary_component;
+    required_components = set.mask;
+    entities->plan_query(required_components, &primary_component);
+    pool = entities->components[primary_component].get();
+}
+
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+template<typename ...ExcludedType>
+inline BasicView<ECSType, FacadeType, ComponentType...> BasicView<ECSType, FacadeType, ComponentType...>::without() const
+{
+    BasicView filtered = *this;
+    filtered.disallowed_components |= detail::get_mask<ExcludedType...>();
+    return filtered;
+}
+
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+inline bool BasicView<ECSType, FacadeType, ComponentType...>::is_match(std::size_t dense_index) const
+{
+    const EntityID& entity = pool->get_owners()[dense_index];
+    const auto& mask = entities->component_masks[entity.index()];
+    return (mask & required_components) == required_components
+        && !(mask & disallowed_components).any()
+        && !entities->is_destroyed(entity);
+}
+
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+inline typename BasicView<ECSType, FacadeType, ComponentType...>::Item BasicView<ECSType, FacadeType, ComponentType...>::get_item(std::size_t dense_index) const
+{
+    const EntityID& entity = pool->get_owners()[dense_index];
+    return Item{ FacadeType(entity, entities), std::make_tuple(get_component<ComponentType>(entity, dense_index)...) };
+}
+
+template<typename ECSType, typename FacadeType, typename ...ComponentType>
+template<typename Type>
+inline Type* BasicView<ECSType, FacadeType, ComponentType...>::get_component(const EntityID& entity, std::size_t dense_index) const
+{
+    auto component_id = detail::get_component_id<detail::RawComponent<Type>>();
+    if (component_id == primary_component)
+    {
+        // Iterated pool, no lookup needed
+        return static_cast<Type*>(pool->get_at(dense_index));
+    }
+    return static_cast<Type*>(entities->get_component_by_id(entity, component_id));
+}
+
+}
@@ -0,0 +1,138 @@
+#include "WorkerPool.h"
+
+#include <diag/Assert.h>
+
+#ifdef __EMSCRIPTEN__
+
+#include <utility>
+
+WorkerPool::WorkerPool(std::size_t thread_count) {}
+
+WorkerPool::~WorkerPool()
+{
+    wait();
+}
+
+void WorkerPool::submit(Job job)
+{
+    T3D_ASSERT(job);
+    pending_jobs.push_back(std::move(job));
+}
+
+void WorkerPool::wait()
+{
+    // Jobs may submit new jobs, so do not hold on to iterators
+    for (std::size_t index = 0; index < pending_jobs.size(); ++index)
+    {
+        Job job = std::move(pending_jobs[index]);
+        job();
+    }
+    pending_jobs.clear();
+}
+
+std::size_t WorkerPool::get_thread_count() const
+{
+    return 0;
+}
+
+std::size_t WorkerPool::get_default_thread_count()
+{
+    return 0;
+}
+
+#else
+
+#include <utility>
+
+WorkerPool::WorkerPool(std::size_t thread_count)
+{
+    threads.reserve(thread_count);
+    for (std::size_t index = 0; index < thread_count; ++index)
+    {
+        threads.emplace_back(&WorkerPool::worker_loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_available.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(Job job)
+{
+    T3D_ASSERT(job);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_jobs.push_back(std::move(job));
+    }
+    job_available.notify_one();
+}
+
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!pending_jobs.empty() || running_jobs > 0)
+    {
+        if (!pending_jobs.empty())
+        {
+            run_job(lock);
+        }
+        else
+        {
+            jobs_done.wait(lock);
+        }
+    }
+}
+
+std::size_t WorkerPool::get_thread_count() const
+{
+    return threads.size();
+}
+
+std::size_t WorkerPool::get_default_thread_count()
+{
+    // The thread calling wait() also runs jobs, so leave one core for it
+    const unsigned hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+void WorkerPool::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        job_available.wait(lock, [this] { return stopping || !pending_jobs.empty(); });
+        if (pending_jobs.empty()) { return; } // Only stops once all jobs are taken
+
+        run_job(lock);
+    }
+}
+
+// Expects the lock to be held and pending_jobs to be non-empty, returns with the lock held
+void WorkerPool::run_job(std::unique_lock<std::mutex>& lock)
+{
+    Job job = std::move(pending_jobs.front());
+    pending_jobs.pop_front();
+    ++running_jobs;
+
+    lock.unlock();
+    job();
+    lock.lock();
+
+    --running_jobs;
+    if (pending_jobs.empty() && running_jobs == 0)
+    {
+        jobs_done.notify_all();
+    }
+}
+
+#endif
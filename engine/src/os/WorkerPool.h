@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
+// Fixed set of worker threads running submitted jobs in submission order.
+// Builds without thread support run every job on the thread that waits for it.
+class WorkerPool
+{
+public:
+    using Job = std::function<void()>;
+
+    explicit WorkerPool(std::size_t thread_count = get_default_thread_count());
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    void submit(Job job);
+    // Blocks until every submitted job has finished, the calling thread runs pending jobs while waiting
+    void wait();
+
+    std::size_t get_thread_count() const;
+    static std::size_t get_default_thread_count();
+
+private:
+#ifdef __EMSCRIPTEN__
+    std::vector<Job> pending_jobs;
+#else
+    void worker_loop();
+    void run_job(std::unique_lock<std::mutex>& lock);
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable jobs_done;
+    std::deque<Job> pending_jobs;
+    std::size_t running_jobs = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+#endif
+};
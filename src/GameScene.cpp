@@ -8,7 +8,6 @@
 #include "entity/ComponentData.h"
 #include "lang/Lang.h"
 #include "level/Network.h"
-#include "level/NetworkGenerator.h"
 #include "level/NetworkTools.h"
 
 static const int ScanWarnTime = 3;
@@ -108,7 +107,7 @@ bool GameScene::can_player_download() const
     auto player = world.entities.find_first<Player>();
     auto player_pos = player.get_component<Position>()->pos;
     auto* tile = world.network.get_tile_safe(player_pos);
-    return tile->type == TileType::Node && tile->node().type == NodeType::DataStore;
+    return tile->get_type() == TileType::Node && tile->node().type == NodeType::DataStore;
 }
 
 bool GameScene::can_player_hack() const
@@ -210,13 +209,13 @@ void GameScene::update_player(const UpdateArgs* args)
         Position* position = player.get_component<Position>();
         auto connector_tile = world.network.get_tile(position->pos + direction);
         ConnectorType expected_type = direction.x ? ConnectorType::Horizontal : ConnectorType::Vertical;
-        if (connector_tile->type == TileType::Connector && connector_tile->connector().type == expected_type)
+        if (connector_tile->get_type() == TileType::Connector && connector_tile->connector().type == expected_type)
         {
             auto current_tile = world.network.get_tile(position->pos);
-            T3D_ASSERT(current_tile->type == TileType::Node);
-            position->pos += direction * 2;
+            T3D_ASSERT(current_tile->get_type() == TileType::Node);
+            world.set_position(player, position->pos + direction * 2);
             auto new_tile = world.network.get_tile(position->pos);
-            T3D_ASSERT(new_tile->type == TileType::Node);
+            T3D_ASSERT(new_tile->get_type() == TileType::Node);
 
             if (new_tile->node().subnet_id != current_tile->node().subnet_id)
             {
@@ -300,7 +299,7 @@ void GameScene::update_player(const UpdateArgs* args)
                 world.score += 1;
                 world.download_progress = 0;
                 // TODO: Really want this to be its own entity instead
-                tile->node().type = NodeType::Normal;
+                tile->set_node_type(NodeType::Normal);
                 world_map_dirty = true;
                 push_bar_explosion(Lang::get(LangID::DownloadComplete));
             }
@@ -313,10 +312,8 @@ void GameScene::update_player(const UpdateArgs* args)
 
 void GameScene::update_enemies(const UpdateArgs* args)
 {
-    attack_system.update(); // Pre-movement damage
-    admin_ai_system.update();
-    monitor_ai_system.update();
-    attack_system.update(); // Post-movement damage
+    // Every stage holds a single system, see init_systems, so handing them to the workers would only add overhead
+    enemy_systems.run(nullptr);
     next_phase();
 }
 
@@ -335,13 +332,19 @@ void GameScene::update_alarm(const UpdateArgs* args)
         // Create scan animation
         {
             ScanAnimation scan_animation;
-            networktools::visit_nodes(world.network, player_pos, [&scan_animation](const networktools::VisitData& data)
+            networktools::Wavefront wavefront;
+            wavefront.begin(world.network, player_pos, world.network.get_walkable_plane());
+            do
             {
-                scan_animation.points.push_back({});
-                scan_animation.points.back().pos = data.pos;
-                scan_animation.points.back().time = static_cast<float>(data.distance_from_start);
-                return networktools::CallbackResult::Continue;
-            });
+                const float time = static_cast<float>(wavefront.get_distance());
+                wavefront.for_each_node([&scan_animation, time](const math::Vec2i& pos)
+                {
+                    scan_animation.points.push_back({});
+                    scan_animation.points.back().pos = pos;
+                    scan_animation.points.back().time = time;
+                });
+            }
+            while (wavefront.advance());
             float latest_time = scan_animation.points.back().time;
             for (auto& point : scan_animation.points)
             {
@@ -385,7 +388,7 @@ void GameScene::cache_world_map()
             auto visibility = world.get_visibility(pos);
 
             auto* tile = world.network.get_tile(pos);
-            if (tile->type == TileType::Node)
+            if (tile->get_type() == TileType::Node)
             {
                 if (visibility == Visibility::Visible)
                 {
@@ -412,7 +415,7 @@ void GameScene::cache_world_map()
                     world_map.blit_character(pos, '?', palette::get(palette::ID::Map_UnknownMarker));
                 }
             }
-            else if (tile->type == TileType::Connector && visibility != Visibility::Hidden)
+            else if (tile->get_type() == TileType::Connector && visibility != Visibility::Hidden)
             {
                 Console::CharCodeType glyph = 0;
                 bool subnet_separator = world.is_subnet_separator(pos);
@@ -454,47 +457,56 @@ void GameScene::render_world(Console* console) const
 
     Array2<Sprite::Layer> zbuffer(console->size.width, console->size.height, Sprite::Layer::None);
     std::vector<math::Vec2i> alert_targets;
-    for (auto& drawable : world.entities.find_all<Position, Sprite>())
+    world.entity_grid.for_each_in(camera_frustum, [this, console, &map_offset, &zbuffer, &alert_targets](const ecs::EntityID& entity_id)
     {
+        if (!world.entities.is_alive(entity_id))
+        {
+            return true; // Destroyed, only waiting for cleanup
+        }
+
+        ecs::ReadOnlyEntityFacade drawable(entity_id, &world.entities);
+        auto* sprite = drawable.get_component<Sprite>();
+        if (!sprite)
+        {
+            return true;
+        }
+
         auto* position = drawable.get_component<Position>();
-        if (camera_frustum.contains(position->pos.x, position->pos.y))
+        auto console_pos = map_offset + position->pos;
+        auto sprite_layer = sprite->layer;
+        auto sprite_glyph = sprite->glyph;
+        auto sprite_color = sprite->color;
+
+        auto visible_state = drawable.get_component<VisibleState>();
+        if (visible_state)
         {
-            auto console_pos = map_offset + position->pos;
-            auto* sprite = drawable.get_component<Sprite>();
-            auto sprite_layer = sprite->layer;
-            auto sprite_glyph = sprite->glyph;
-            auto sprite_color = sprite->color;
-
-            auto visible_state = drawable.get_component<VisibleState>();
-            if (visible_state)
+            if (visible_state->alerted)
             {
-                if (visible_state->alerted)
+                if (animator.is_alert_visible())
                 {
-                    if (animator.is_alert_visible())
-                    {
-                        // Always show alert pip, even when owner is not visible
-                        alert_targets.push_back(visible_state->alert_target);
-                        sprite_glyph = '!';
-                    }
+                    // Always show alert pip, even when owner is not visible
+                    alert_targets.push_back(visible_state->alert_target);
+                    sprite_glyph = '!';
                 }
-                if (visible_state->disabled)
+            }
+            if (visible_state->disabled)
+            {
+                sprite_layer = Sprite::Layer::Disabled;
+                sprite_color = palette::ID::Enemy_Disabled;
+                if (animator.is_alert_visible())
                 {
-                    sprite_layer = Sprite::Layer::Disabled;
-                    sprite_color = palette::ID::Enemy_Disabled;
-                    if (animator.is_alert_visible())
-                    {
-                        sprite_glyph = '/';
-                    }
+                    sprite_glyph = '/';
                 }
             }
+        }
 
-            if (zbuffer.at(console_pos.x, console_pos.y) < sprite_layer && world.get_visibility(position->pos) != Visibility::Hidden)
-            {
-                zbuffer.at(console_pos.x, console_pos.y) = sprite_layer;
-                console->blit_character(map_offset + position->pos, sprite_glyph, palette::get(sprite_color));
-            }
+        if (zbuffer.at(console_pos.x, console_pos.y) < sprite_layer && world.get_visibility(position->pos) != Visibility::Hidden)
+        {
+            zbuffer.at(console_pos.x, console_pos.y) = sprite_layer;
+            console->blit_character(map_offset + position->pos, sprite_glyph, palette::get(sprite_color));
         }
-    }
+        return true;
+    });
 
     for (auto& target : alert_targets)
     {
@@ -611,6 +623,7 @@ void GameScene::init(Random& seed_rng)
     monitor_ai_system.world = &world;
     monitor_ai_system.animator = &animator;
     attack_system.world = &world;
+    init_systems();
     phase = Phase::PlayerActions;
 
     int world_seed = seed_rng.next();
@@ -622,6 +635,23 @@ void GameScene::init(Random& seed_rng)
     init_level();
 }
 
+void GameScene::init_systems()
+{
+    enemy_systems.clear();
+
+    auto attack_access = ecs::SystemAccess().read<PlayerAttacker, Position>().write<Player>();
+    // AI systems add and remove walkers and move entities through the shared entity grid and path cache,
+    // the admin also uses the gameplay rng and the animator. With a handful of enemies per level the turn is
+    // cheaper to run in order than to split into deferred commands.
+    auto admin_ai_access = ecs::SystemAccess().exclusive();
+    auto monitor_ai_access = ecs::SystemAccess().exclusive();
+
+    enemy_systems.add(attack_access, [this] { attack_system.update(); }); // Pre-movement damage
+    enemy_systems.add(admin_ai_access, [this] { admin_ai_system.update(); });
+    enemy_systems.add(monitor_ai_access, [this] { monitor_ai_system.update(); });
+    enemy_systems.add(attack_access, [this] { attack_system.update(); }); // Post-movement damage
+}
+
 void GameScene::go_to_next_level()
 {
     world.level += 1;
@@ -637,14 +667,15 @@ void GameScene::init_level()
     world.max_alarm = 15;
     world.exit_strength = world.level;
     world.max_alarm_level = world.level;
-    networkgenerator::generate(world.seed + world.level, &world.network);
+    level_prefetcher.take(world.seed + world.level, &world.network, &workers);
     world.known_subnets.resize(world.network.subnet_count);
     world.visibility_map.resize(world.network.size.width, world.network.size.height, Visibility::Hidden);
+    world.entity_grid.reset(world.network.size.width, world.network.size.height);
 
     {
         auto player = world.entities.create_entity();
         player.add_component<Player>();
-        player.add_component<Position>()->pos = world.network.entrance;
+        player.add_component<Position>(Position{world.network.entrance});
         auto* sprite = player.add_component<Sprite>();
         sprite->glyph = '@';
         sprite->layer = Sprite::Layer::Player;
@@ -653,5 +684,6 @@ void GameScene::init_level()
         world.known_subnets[world.network.get_tile(world.network.entrance)->node().subnet_id] = true;
     }
 
+    level_prefetcher.request(world.seed + world.level + 1);
     world_map_dirty = true;
 }
@@ -9,6 +9,9 @@
 #include "game/World.h"
 #include "hud/ProgressBar.h"
 #include "input/Input.h"
+#include "level/LevelPrefetcher.h"
+#include <ecs/Scheduler.h>
+#include <os/WorkerPool.h>
 #include <text/Console.h>
 
 class GameScene : public Scene
@@ -29,6 +32,7 @@ public:
 
 private:
     void init(Random& rng);
+    void init_systems();
     void init_level();
     void go_to_next_level();
     void update(const UpdateArgs* args);
@@ -59,6 +63,9 @@ private:
     PlayerAttackSystem attack_system;
     SystemAdminAI admin_ai_system;
     SystemMonitorAI monitor_ai_system;
+    ecs::Scheduler enemy_systems;
+    WorkerPool workers; // Builds the distance table of each level
+    LevelPrefetcher level_prefetcher;
     Console world_map;
     ProgressBar progress_bar;
     DeathScene death_scene;
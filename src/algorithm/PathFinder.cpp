@@ -1,86 +1,132 @@
 #include "PathFinder.h"
 
-#include <RangeUtil.h>
-#include <game/World.h>
+#include <diag/Assert.h>
 
 #include <algorithm>
-#include <functional>
-#include <iterator>
-#include <queue>
-#include <unordered_set>
-
-static const float InfiniteCost = 1000000000000.0f;
 
 namespace pathfinder
 {
+namespace detail
+{
+
+namespace
+{
 
-struct Node
+// Lower f first, on ties prefer the node furthest from the start as it is likely closer to the goal
+inline bool is_better(const OpenNode& lhs, const OpenNode& rhs)
 {
-    Node(float g = InfiniteCost, float f = InfiniteCost) : g(g), f(f) {}
+    return lhs.f < rhs.f || (lhs.f == rhs.f && lhs.g > rhs.g);
+}
 
-    float g; // cost from start to this node
-    float f; // cost from start to goal through this node
-};
+thread_local SearchContext search_context;
 
-using StoredType = std::pair<NodeID, Node>;
+}
 
-NodeList find_path(const GraphWalker& world, const NodeID& start, const NodeID& end)
+const unsigned SearchContext::ClosedIndex;
+constexpr float SearchContext::InfiniteCost;
+
+void SearchContext::begin(std::size_t node_count)
 {
-    std::unordered_set<NodeID> closed_set;
-    std::unordered_map<NodeID, Node> open_set;
-    open_set.insert({start, {0.0f, world.get_estimated_cost(start, end)}});
+    if (stamps.size() < node_count)
+    {
+        stamps.resize(node_count, 0);
+        g_costs.resize(node_count);
+        parents.resize(node_count);
+        heap_indices.resize(node_count);
+    }
 
-    NodeList path;
-    std::unordered_map<NodeID, NodeID> found_path;
-    while (!open_set.empty())
+    ++generation;
+    if (generation == 0)
     {
-        auto current = range::min_element(open_set, [](const StoredType& lhs, const StoredType& rhs) { return lhs.second.g < rhs.second.g; });
-        auto current_pos = current->first;
-        auto current_data = current->second;
-        if (current_pos == end)
-        {
-            path.push_back(current_pos);
-            while (found_path.find(current_pos) != std::end(found_path))
-            {
-                current_pos = found_path[current_pos];
-                path.push_back(current_pos);
-            }
-            break;
-        }
+        // Stamps wrapped around, old entries could match again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+    open_nodes.clear();
+}
+
+void SearchContext::push_or_update(NodeID id, NodeID parent, float g, float f)
+{
+    parents[id] = parent;
+    g_costs[id] = g;
+    if (!is_seen(id))
+    {
+        stamps[id] = generation;
+        open_nodes.push_back({f, g, id});
+        heap_indices[id] = static_cast<unsigned>(open_nodes.size() - 1);
+        sift_up(open_nodes.size() - 1);
+    }
+    else
+    {
+        T3D_ASSERT(heap_indices[id] != ClosedIndex); // Consistent heuristics never reopen nodes
+        const std::size_t heap_index = heap_indices[id];
+        open_nodes[heap_index].f = f;
+        open_nodes[heap_index].g = g;
+        sift_up(heap_index);
+    }
+}
 
-        open_set.erase(current);
-        closed_set.emplace(current_pos);
+NodeID SearchContext::pop()
+{
+    T3D_ASSERT(!open_nodes.empty());
+    const NodeID id = open_nodes.front().id;
+    heap_indices[id] = ClosedIndex;
 
-        for (auto& neighbour_data : world.get_neighbours(current_pos))
+    const OpenNode last = open_nodes.back();
+    open_nodes.pop_back();
+    if (!open_nodes.empty())
+    {
+        place(0, last);
+        sift_down(0);
+    }
+    return id;
+}
+
+inline void SearchContext::place(std::size_t heap_index, const OpenNode& node)
+{
+    open_nodes[heap_index] = node;
+    heap_indices[node.id] = static_cast<unsigned>(heap_index);
+}
+
+void SearchContext::sift_up(std::size_t heap_index)
+{
+    const OpenNode node = open_nodes[heap_index];
+    while (heap_index > 0)
+    {
+        const std::size_t parent_index = (heap_index - 1) / 2;
+        if (!is_better(node, open_nodes[parent_index])) { break; }
+
+        place(heap_index, open_nodes[parent_index]);
+        heap_index = parent_index;
+    }
+    place(heap_index, node);
+}
+
+void SearchContext::sift_down(std::size_t heap_index)
+{
+    const OpenNode node = open_nodes[heap_index];
+    const std::size_t count = open_nodes.size();
+    while (true)
+    {
+        std::size_t child_index = heap_index * 2 + 1;
+        if (child_index >= count) { break; }
+
+        if (child_index + 1 < count && is_better(open_nodes[child_index + 1], open_nodes[child_index]))
         {
-            if (closed_set.find(neighbour_data) != std::end(closed_set))
-            {
-                continue;
-            }
-
-            float tentative_g = current_data.g + world.get_cost(current_pos, neighbour_data);
-
-            auto stored_in_open = open_set.find(neighbour_data);
-            if (stored_in_open == std::end(open_set))
-            {
-                open_set.insert({neighbour_data, {}});
-                stored_in_open = open_set.find(neighbour_data);
-                T3D_ASSERT(stored_in_open != std::end(open_set));
-            }
-            else if (stored_in_open->second.g <= tentative_g)
-            {
-                continue;
-            }
-
-            found_path[neighbour_data] = current_pos;
-            stored_in_open->second.g = tentative_g;
-            stored_in_open->second.f = tentative_g + world.get_estimated_cost(neighbour_data, end);
+            ++child_index;
         }
+        if (!is_better(open_nodes[child_index], node)) { break; }
+
+        place(heap_index, open_nodes[child_index]);
+        heap_index = child_index;
     }
+    place(heap_index, node);
+}
 
-    std::vector<NodeID> fixed_path;
-    fixed_path.assign(path.rbegin(), path.rend());
-    return fixed_path;
+SearchContext& get_search_context()
+{
+    return search_context;
 }
 
 }
+}
@@ -2,21 +2,115 @@
 
 #include <math/Vec2.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
-struct World;
-
 namespace pathfinder
 {
     using NodeID = unsigned;
     using NodeList = std::vector<NodeID>;
 
-    struct GraphWalker
+    // find_path accepts any walker type providing:
+    //
+    //     std::size_t get_node_count() const;
+    //     template<typename CallbackType> void for_each_neighbour(NodeID id, CallbackType callback) const; // callback(NodeID neighbour, float cost)
+    //     float get_estimated_cost(NodeID start, NodeID end) const;
+    //
+    // NodeIDs must be smaller than get_node_count().
+    // The estimated cost must never exceed the real cost and never drop by more than the cost of a step, otherwise
+    // paths are no longer guaranteed to be the shortest.
+
+    // A* search, returns the nodes from start to end or an empty list when end cannot be reached
+    template<typename WalkerType>
+    NodeList find_path(const WalkerType& walker, const NodeID& start, const NodeID& end);
+
+    namespace detail
     {
-        virtual NodeList get_neighbours(NodeID id) const = 0;
-        virtual float get_cost(NodeID start, NodeID end) const = 0;
-        virtual float get_estimated_cost(NodeID start, NodeID end) const = 0;
-    };
+        struct OpenNode
+        {
+            float f; // cost from start to goal through this node
+            float g; // cost from start to this node
+            NodeID id;
+        };
+
+        // Per-node search state lives in flat arrays indexed by NodeID.
+        // Entries only count when their stamp matches the current search, so nothing needs clearing between searches.
+        class SearchContext
+        {
+        public:
+            static const unsigned ClosedIndex = static_cast<unsigned>(-1);
+
+            void begin(std::size_t node_count);
+
+            bool is_seen(NodeID id) const { return stamps[id] == generation; }
+            bool is_closed(NodeID id) const { return is_seen(id) && heap_indices[id] == ClosedIndex; }
+            float get_g(NodeID id) const { return is_seen(id) ? g_costs[id] : InfiniteCost; }
+            NodeID get_parent(NodeID id) const { return parents[id]; }
+
+            void push_or_update(NodeID id, NodeID parent, float g, float f);
+            bool empty() const { return open_nodes.empty(); }
+            NodeID pop();
+
+        private:
+            static constexpr float InfiniteCost = 1000000000000.0f;
+
+            void place(std::size_t heap_index, const OpenNode& node);
+            void sift_up(std::size_t heap_index);
+            void sift_down(std::size_t heap_index);
+
+            unsigned generation = 0;
+            std::vector<unsigned> stamps;
+            std::vector<float> g_costs;
+            std::vector<NodeID> parents;
+            std::vector<unsigned> heap_indices; // Position in open_nodes, or ClosedIndex
+            std::vector<OpenNode> open_nodes; // Binary heap
+        };
+
+        // One context per thread, reused between searches
+        SearchContext& get_search_context();
+    }
+}
+
+template<typename WalkerType>
+pathfinder::NodeList pathfinder::find_path(const WalkerType& walker, const NodeID& start, const NodeID& end)
+{
+    detail::SearchContext& context = detail::get_search_context();
+    context.begin(walker.get_node_count());
+    context.push_or_update(start, start, 0.0f, walker.get_estimated_cost(start, end));
+
+    NodeList path;
+    while (!context.empty())
+    {
+        const NodeID current = context.pop();
+        if (current == end)
+        {
+            for (NodeID node = end; node != start; node = context.get_parent(node))
+            {
+                path.push_back(node);
+            }
+            path.push_back(start);
+            std::reverse(path.begin(), path.end());
+            break;
+        }
+
+        const float current_g = context.get_g(current);
+        walker.for_each_neighbour(current, [&](NodeID neighbour, float cost)
+        {
+            if (context.is_closed(neighbour))
+            {
+                return;
+            }
+
+            const float tentative_g = current_g + cost;
+            if (context.get_g(neighbour) <= tentative_g)
+            {
+                return;
+            }
+
+            context.push_or_update(neighbour, current, tentative_g, tentative_g + walker.get_estimated_cost(neighbour, end));
+        });
+    }
 
-    NodeList find_path(const GraphWalker& world, const NodeID& start, const NodeID& end);
+    return path;
 }
@@ -5,8 +5,10 @@
 #include <math/Vec2.h>
 
 #include <array>
+#include <memory>
 #include <vector>
 
+// Move entities through World::set_position to keep World::entity_grid up to date
 struct Position
 {
     math::Vec2i pos;
@@ -51,7 +53,7 @@ struct PlayerAttacker {};
 
 struct Walker
 {
-    std::vector<math::Vec2i> walk_path;
+    std::shared_ptr<const std::vector<math::Vec2i>> walk_path; // Shared with World::path_cache
     std::size_t path_index = 0;
 };
 
@@ -4,18 +4,21 @@
 #include <RandomUtil.h>
 #include <animation/Animator.h>
 #include <game/World.h>
+#include <level/DistanceField.h>
 #include <level/NetworkTools.h>
 
 std::vector<ecs::EntityFacade> PositionSystem::get_entities_at(const math::Vec2i& pos)
 {
     std::vector<ecs::EntityFacade> entities;
-    for (auto& entity : world->entities.find_all<Position>())
+    world->entity_grid.for_each_at(pos, [this, &entities](const ecs::EntityID& entity)
     {
-        if (entity.get_component<Position>()->pos == pos)
+        // The grid keeps destroyed entities until they are cleaned up
+        if (world->entities.is_alive(entity))
         {
-            entities.push_back(entity);
+            entities.emplace_back(entity, &world->entities);
         }
-    }
+        return true;
+    });
     return entities;
 }
 
@@ -24,19 +27,17 @@ void DisabledStatusSystem::update()
     auto player = world->entities.find_first<Player>();
     auto player_pos = player.get_component<Position>()->pos;
 
-    auto entities = world->entities.find_all<DisabledStatus>();
-    for (auto& entity : entities)
+    for (auto item : world->entities.view<DisabledStatus, Position>())
     {
-        auto* position = entity.get_component<Position>();
-        if (position->pos == player_pos)
+        if (item.get<Position>()->pos == player_pos)
         {
             continue;
         }
 
-        auto* disabled = entity.get_component<DisabledStatus>();
+        auto* disabled = item.get<DisabledStatus>();
         --disabled->num_turns;
 
-        auto* visible_state = entity.get_component<VisibleState>();
+        auto* visible_state = item.entity.get_component<VisibleState>();
         if (visible_state)
         {
             visible_state->disabled = disabled->num_turns > 0;
@@ -44,9 +45,10 @@ void DisabledStatusSystem::update()
 
         if (disabled->num_turns == 0)
         {
-            entity.remove_component<DisabledStatus>();
+            commands.remove_component<DisabledStatus>(item.entity.entity_id());
         }
     }
+    commands.apply(world->entities);
 }
 
 void PlayerAttackSystem::update()
@@ -54,56 +56,63 @@ void PlayerAttackSystem::update()
     auto player = world->entities.find_first<Player>();
     auto player_pos = player.get_component<Position>()->pos;
 
-    auto entities = world->entities.find_all<PlayerAttacker, Position>();
-    for (auto& entity : entities)
+    world->entity_grid.for_each_at(player_pos, [this, &player](const ecs::EntityID& entity)
     {
-        auto position = entity.get_component<Position>()->pos;
-        if (player_pos == position)
+        if (world->entities.is_alive(entity) && world->entities.has_component<PlayerAttacker>(entity))
         {
             player.get_component<Player>()->attacked = true;
-            break;
+            return false;
         }
-    }
+        return true;
+    });
 }
 
-void WalkerSystem::create_path(ecs::EntityFacade& entity, const math::Vec2i& from, const math::Vec2i& to, World* world)
+static void start_walking(ecs::EntityFacade& entity, const math::Vec2i& from, std::shared_ptr<const std::vector<math::Vec2i>> new_path)
 {
-    if (from == to) { return; }
-
-    auto new_path = networktools::find_path(world->network, from, to);
-    if (!new_path.empty())
+    if (!new_path->empty())
     {
-        T3D_ASSERT(new_path[0] == from);
+        T3D_ASSERT((*new_path)[0] == from);
         auto* walker = entity.ensure_component<Walker>();
         walker->walk_path = std::move(new_path);
         walker->path_index = 1; // First node is always starting point
     }
 }
 
-void WalkerSystem::update(ecs::EntityFacade& entity)
+void WalkerSystem::create_path(ecs::EntityFacade& entity, const math::Vec2i& from, const math::Vec2i& to, World* world)
+{
+    if (from == to) { return; }
+
+    start_walking(entity, from, world->find_path(from, to));
+}
+
+void WalkerSystem::create_path(ecs::EntityFacade& entity, const math::Vec2i& from, const networktools::DistanceField& field, World* world)
+{
+    if (from == field.get_target()) { return; }
+
+    start_walking(entity, from, std::make_shared<const std::vector<math::Vec2i>>(field.get_path(world->network, from)));
+}
+
+void WalkerSystem::update(ecs::EntityFacade& entity, World* world)
 {
     auto* walker = entity.get_component<Walker>();
-    auto* position = entity.get_component<Position>();
-    T3D_ASSERT(walker && position);
-    position->pos = walker->walk_path[walker->path_index];
+    T3D_ASSERT(walker && entity.has_component<Position>());
+    world->set_position(entity, (*walker->walk_path)[walker->path_index]);
     ++walker->path_index;
-    if (walker->path_index >= walker->walk_path.size())
+    if (walker->path_index >= walker->walk_path->size())
     {
         // Walk complete, remove component
         entity.remove_component<Walker>();
     }
 }
 
-static const ecs::Aspect ActiveAIAspect = ecs::Aspect::all_with<AdminAI>().and_without<DisabledStatus>();
-
 void SystemAdminAI::create(math::Vec2i pos)
 {
-    T3D_ASSERT(world->network.get_tile_safe(pos)->type == TileType::Node); // Always start out on a network node
+    T3D_ASSERT(world->network.get_tile_safe(pos)->get_type() == TileType::Node); // Always start out on a network node
 
     auto admin_enemy = world->entities.create_entity();
     admin_enemy.add_component<AdminAI>();
     admin_enemy.add_component<PlayerAttacker>();
-    admin_enemy.add_component<Position>()->pos = pos;
+    admin_enemy.add_component<Position>(Position{pos});
     auto* sprite = admin_enemy.add_component<Sprite>();
     sprite->glyph = 'A';
     sprite->color = palette::ID::Enemy;
@@ -125,10 +134,10 @@ void SystemAdminAI::reset_state(ecs::EntityFacade& entity)
 
 void SystemAdminAI::update()
 {
-    auto entities = world->entities.find_all<AdminAI>();
-    for (auto& entity : entities)
+    for (auto item : world->entities.view<AdminAI>())
     {
-        auto* ai = entity.get_component<AdminAI>();
+        auto& entity = item.entity;
+        auto* ai = item.get<AdminAI>();
         auto* disabled_status = entity.get_component<DisabledStatus>();
         auto* visible_state = entity.get_component<VisibleState>();
         if (disabled_status)
@@ -153,7 +162,7 @@ void SystemAdminAI::update()
 
         if (entity.has_component<Walker>())
         {
-            WalkerSystem::update(entity);
+            WalkerSystem::update(entity, world);
         }
         else
         {
@@ -164,22 +173,19 @@ void SystemAdminAI::update()
             // Create scan animation
             {
                 ScanAnimation scan_animation;
-                networktools::visit_nodes(world->network, position->pos, [subnet, &scan_animation, this](const networktools::VisitData& data)
+                world->network.get_subnet_plane(subnet, scan_mask);
+                scan_wavefront.begin(world->network, position->pos, scan_mask);
+                do
                 {
-                    Tile* tile = world->network.get_tile(data.pos);
-                    SubnetID tile_subnet = tile->node().subnet_id;
-                    if (subnet == tile_subnet)
+                    const float time = static_cast<float>(scan_wavefront.get_distance());
+                    scan_wavefront.for_each_node([&scan_animation, time](const math::Vec2i& pos)
                     {
                         scan_animation.points.push_back({});
-                        scan_animation.points.back().pos = data.pos;
-                        scan_animation.points.back().time = static_cast<float>(data.distance_from_start);
-                        return networktools::CallbackResult::Continue;
-                    }
-                    else
-                    {
-                        return networktools::CallbackResult::StopVisitor;
-                    }
-                });
+                        scan_animation.points.back().pos = pos;
+                        scan_animation.points.back().time = time;
+                    });
+                }
+                while (scan_wavefront.advance());
                 float latest_time = scan_animation.points.back().time;
                 for (auto& point : scan_animation.points)
                 {
@@ -203,25 +209,29 @@ void SystemAdminAI::update()
                     ai->scanned_ids[subnet] = true; // We already are in this subnet, so mark this one as done
                 }
 
+                // The first node reached in an unscanned subnet decides which subnet is nearest
                 SubnetID nearest_unknown_subnet = SubnetIDNull;
-                std::vector<math::Vec2i> unknown_nodes;
-                auto subnet_finder = [&nearest_unknown_subnet, &unknown_nodes, ai, this](const networktools::VisitData& data)
+                auto subnet_finder = [&nearest_unknown_subnet, ai, this](const networktools::VisitData& data)
                 {
                     Tile* tile = world->network.get_tile(data.pos);
                     SubnetID subnet = tile->node().subnet_id;
-                    if (nearest_unknown_subnet == SubnetIDNull && !ai->scanned_ids[subnet])
+                    if (!ai->scanned_ids[subnet])
                     {
                         nearest_unknown_subnet = subnet;
-                    }
-
-                    if (subnet == nearest_unknown_subnet)
-                    {
-                        unknown_nodes.push_back(data.pos);
+                        return networktools::CallbackResult::StopAllVisitors;
                     }
 
                     return networktools::CallbackResult::Continue;
                 };
                 networktools::visit_nodes(world->network, position->pos, subnet_finder);
+                T3D_ASSERT(nearest_unknown_subnet != SubnetIDNull);
+
+                auto subnet_nodes = world->network.subnet_topology.get_nodes(nearest_unknown_subnet);
+                std::vector<math::Vec2i> unknown_nodes(subnet_nodes.get_size());
+                for (std::size_t index = 0; index < subnet_nodes.get_size(); ++index)
+                {
+                    unknown_nodes[index] = world->network.get_node_pos(subnet_nodes[index]);
+                }
 
                 auto target_node = util::choose(unknown_nodes, world->gameplay_rng);
                 WalkerSystem::create_path(entity, position->pos, target_node, world);
@@ -234,15 +244,14 @@ void SystemAdminAI::alert_nearest()
 {
     ecs::EntityFacade nearest;
     int nearest_distance = 0;
-    auto entities = world->entities.find_all(ActiveAIAspect);
     auto player_pos = world->entities.find_first<Player>().get_component<Position>()->pos;
-    for (auto& entity : entities)
+    for (auto item : world->entities.view<const AdminAI, const Position>().without<DisabledStatus>())
     {
-        Position* pos = entity.get_component<Position>();
+        const Position* pos = item.get<Position>();
         int distance = math::distance2(pos->pos, player_pos);
         if (nearest_distance == 0 || nearest_distance > distance)
         {
-            nearest = entity;
+            nearest = item.entity;
             nearest_distance = distance;
         }
     }
@@ -262,20 +271,21 @@ void SystemAdminAI::send_to_investigate(ecs::EntityFacade& entity, const math::V
     animation.entity = entity.entity_id();
     animator->focus_animations.push_back(animation);
     Position* position = entity.get_component<Position>();
-    WalkerSystem::create_path(entity, position->pos, target, world);
+    // Alerts usually send several agents to the player, they all share one field
+    WalkerSystem::create_path(entity, position->pos, world->get_distance_field(target), world);
 }
 
 void SystemMonitorAI::create(math::Vec2i point_a, math::Vec2i point_b)
 {
-    T3D_ASSERT(world->network.get_tile_safe(point_a)->type == TileType::Node); // Always start out on a network node
-    T3D_ASSERT(world->network.get_tile_safe(point_b)->type == TileType::Node); // Always end on a network node
+    T3D_ASSERT(world->network.get_tile_safe(point_a)->get_type() == TileType::Node); // Always start out on a network node
+    T3D_ASSERT(world->network.get_tile_safe(point_b)->get_type() == TileType::Node); // Always end on a network node
 
     auto entity = world->entities.create_entity();
     auto* ai = entity.add_component<MonitorAI>();
     ai->patrol_points[0] = point_a;
     ai->patrol_points[1] = point_b;
     entity.add_component<PlayerAttacker>();
-    entity.add_component<Position>()->pos = ai->patrol_points[0];
+    entity.add_component<Position>(Position{ai->patrol_points[0]});
     auto* sprite = entity.add_component<Sprite>();
     sprite->glyph = 'a';
     sprite->color = palette::ID::Enemy;
@@ -295,10 +305,10 @@ void SystemMonitorAI::reset_state(ecs::EntityFacade& entity)
 
 void SystemMonitorAI::update()
 {
-    auto entities = world->entities.find_all<MonitorAI>();
-    for (auto& entity : entities)
+    for (auto item : world->entities.view<MonitorAI>())
     {
-        auto* ai = entity.get_component<MonitorAI>();
+        auto& entity = item.entity;
+        auto* ai = item.get<MonitorAI>();
         auto* disabled_status = entity.get_component<DisabledStatus>();
         if (disabled_status)
         {
@@ -316,7 +326,7 @@ void SystemMonitorAI::update()
 
         if (entity.has_component<Walker>())
         {
-            WalkerSystem::update(entity);
+            WalkerSystem::update(entity, world);
         }
         else
         {
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <ecs/CommandBuffer.h>
+#include <ds/BitPlane.h>
 #include <ecs/ECS.h>
+#include <level/NetworkTools.h>
 #include <math/Vec2.h>
 
 #include <vector>
@@ -8,6 +11,8 @@
 struct World;
 struct Animator;
 
+namespace networktools { class DistanceField; }
+
 struct PositionSystem
 {
     World* world = nullptr;
@@ -18,6 +23,7 @@ struct PositionSystem
 struct DisabledStatusSystem
 {
     World* world = nullptr;
+    ecs::CommandBuffer commands;
 
     void update();
 };
@@ -32,13 +38,16 @@ struct PlayerAttackSystem
 struct WalkerSystem
 {
     static void create_path(ecs::EntityFacade& entity, const math::Vec2i& from, const math::Vec2i& to, World* world);
-    static void update(ecs::EntityFacade& entity);
+    static void create_path(ecs::EntityFacade& entity, const math::Vec2i& from, const networktools::DistanceField& field, World* world);
+    static void update(ecs::EntityFacade& entity, World* world);
 };
 
 struct SystemAdminAI
 {
     World* world = nullptr;
     Animator* animator = nullptr;
+    BitPlane scan_mask;
+    networktools::Wavefront scan_wavefront;
 
     void create(math::Vec2i pos);
     void reset_state(ecs::EntityFacade& entity);
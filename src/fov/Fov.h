@@ -4,11 +4,43 @@
 
 #include <functional>
 #include <bitset>
+#include <cstddef>
+#include <vector>
 
 namespace fov
 {
     using OctantSet = std::bitset<8>;
 
+    namespace detail
+    {
+        struct Slope // represents the slope Y/X as a rational number
+        {
+            Slope(unsigned y, unsigned x) : X(x), Y(y) {}
+
+            bool Greater(unsigned y, unsigned x) const { return Y*x > X*y; } // this > y/x
+            bool GreaterOrEqual(unsigned y, unsigned x) const { return Y*x >= X*y; } // this >= y/x
+            bool Less(unsigned y, unsigned x) const { return Y*x < X*y; } // this < y/x
+                                                                          //public bool LessOrEqual(uint y, uint x) { return Y*x <= X*y; } // this <= y/x
+
+            unsigned X, Y;
+        };
+
+        // Part of an octant still to be traced, starting at column x
+        struct Sector
+        {
+            unsigned x;
+            Slope top;
+            Slope bottom;
+        };
+
+        // Shared by every compute on the thread so creating a Visibility per call does not allocate
+        inline std::vector<Sector>& get_sector_stack()
+        {
+            thread_local std::vector<Sector> sectors;
+            return sectors;
+        }
+    }
+
     // Taken and converted from http://www.adammil.net/blog/v125_Roguelike_Vision_Algorithms.html#mine
     class MyVisibility
     {
@@ -20,17 +52,7 @@ namespace fov
         using uint = unsigned;
 
     private:
-        struct Slope // represents the slope Y/X as a rational number
-        {
-            Slope(uint y, uint x) : X(x), Y(y) {}
-
-            bool Greater(uint y, uint x) const { return Y*x > X*y; } // this > y/x
-            bool GreaterOrEqual(uint y, uint x) const { return Y*x >= X*y; } // this >= y/x
-            bool Less(uint y, uint x) const { return Y*x < X*y; } // this < y/x
-                                                                  //public bool LessOrEqual(uint y, uint x) { return Y*x <= X*y; } // this <= y/x
-
-            uint X, Y;
-        };
+        using Slope = detail::Slope;
 
     public:
         /// <param name="blocksLight">A function that accepts the X and Y coordinates of a tile and determines whether the
@@ -83,4 +105,183 @@ namespace fov
         GetDistanceFunc GetDistance;
         SetVisibleFunc _setVisible;
     };
+
+    // MyVisibility with the callbacks as template parameters so they inline into the column loop,
+    // see Fov.cpp for how the sectors are traced. Sectors split off by walls are queued on a per-thread stack
+    // instead of recursing.
+    template<typename BlocksLightType, typename SetVisibleType, typename GetDistanceType>
+    class Visibility
+    {
+    public:
+        // Same contracts as the MyVisibility callbacks: blocks_light(int x, int y) -> bool, set_visible(int x, int y)
+        // and get_distance(int x, int y) -> int relative to the origin with x >= y >= 0
+        Visibility(BlocksLightType blocks_light, SetVisibleType set_visible, GetDistanceType get_distance)
+            : blocks_light(blocks_light), set_visible(set_visible), get_distance(get_distance)
+        {}
+
+        // A negative range_limit means unlimited range
+        void compute(const math::Vec2i& origin, OctantSet octants_to_compute, int range_limit);
+
+    private:
+        using Slope = detail::Slope;
+        using Sector = detail::Sector;
+
+        // Maps octant coordinates to level coordinates without branching on the octant per tile
+        struct Octant
+        {
+            math::Vec2i origin;
+            int xx, xy, yx, yy;
+
+            int get_x(unsigned x, unsigned y) const { return origin.x + xx * static_cast<int>(x) + xy * static_cast<int>(y); }
+            int get_y(unsigned x, unsigned y) const { return origin.y + yx * static_cast<int>(x) + yy * static_cast<int>(y); }
+        };
+
+        void compute_sector(const Octant& octant, int range_limit, Sector sector, std::vector<Sector>& sectors);
+        bool is_opaque(const Octant& octant, unsigned x, unsigned y) { return blocks_light(octant.get_x(x, y), octant.get_y(x, y)); }
+
+        BlocksLightType blocks_light;
+        SetVisibleType set_visible;
+        GetDistanceType get_distance;
+    };
+
+    template<typename BlocksLightType, typename SetVisibleType, typename GetDistanceType>
+    Visibility<BlocksLightType, SetVisibleType, GetDistanceType> make_visibility(BlocksLightType blocks_light, SetVisibleType set_visible, GetDistanceType get_distance)
+    {
+        return {blocks_light, set_visible, get_distance};
+    }
+}
+
+template<typename BlocksLightType, typename SetVisibleType, typename GetDistanceType>
+void fov::Visibility<BlocksLightType, SetVisibleType, GetDistanceType>::compute(const math::Vec2i& origin, OctantSet octants_to_compute, int range_limit)
+{
+    // Same octant order and orientation as MyVisibility
+    static const int transforms[8][4] =
+    {
+        { 1,  0,  0, -1},
+        { 0,  1, -1,  0},
+        { 0, -1, -1,  0},
+        {-1,  0,  0, -1},
+        {-1,  0,  0,  1},
+        { 0, -1,  1,  0},
+        { 0,  1,  1,  0},
+        { 1,  0,  0,  1},
+    };
+
+    std::vector<Sector>& sectors = detail::get_sector_stack();
+    const std::size_t first_sector = sectors.size();
+    set_visible(origin.x, origin.y);
+    for (unsigned octant_index = 0; octant_index < 8; ++octant_index)
+    {
+        if (!octants_to_compute[octant_index])
+        {
+            continue;
+        }
+
+        const int* transform = transforms[octant_index];
+        const Octant octant{origin, transform[0], transform[1], transform[2], transform[3]};
+        sectors.push_back({1, Slope(1, 1), Slope(0, 1)});
+        while (sectors.size() > first_sector) // Callbacks may start a compute of their own on top
+        {
+            const Sector sector = sectors.back();
+            sectors.pop_back();
+            compute_sector(octant, range_limit, sector, sectors);
+        }
+    }
+}
+
+template<typename BlocksLightType, typename SetVisibleType, typename GetDistanceType>
+void fov::Visibility<BlocksLightType, SetVisibleType, GetDistanceType>::compute_sector(const Octant& octant, int range_limit, Sector sector, std::vector<Sector>& sectors)
+{
+    Slope& top = sector.top;
+    Slope& bottom = sector.bottom;
+    for (unsigned x = sector.x; x <= static_cast<unsigned>(range_limit); ++x) // Unsigned, so a negative range never ends
+    {
+        // Rows the top and bottom vectors pass through in this column, top > bottom
+        unsigned top_y = x;
+        if (top.X != 1)
+        {
+            top_y = ((x * 2 - 1) * top.Y + top.X) / (top.X * 2);
+            if (is_opaque(octant, x, top_y))
+            {
+                if (top.GreaterOrEqual(top_y * 2 + 1, x * 2) && !is_opaque(octant, x, top_y + 1)) { ++top_y; }
+            }
+            else
+            {
+                unsigned ax = x * 2;
+                if (is_opaque(octant, x + 1, top_y + 1)) { ++ax; }
+                if (top.Greater(top_y * 2 + 1, ax)) { ++top_y; }
+            }
+        }
+
+        unsigned bottom_y = 0;
+        if (bottom.Y != 0)
+        {
+            bottom_y = ((x * 2 - 1) * bottom.Y + bottom.X) / (bottom.X * 2);
+            if (bottom.GreaterOrEqual(bottom_y * 2 + 1, x * 2) && is_opaque(octant, x, bottom_y) && !is_opaque(octant, x, bottom_y + 1))
+            {
+                ++bottom_y;
+            }
+        }
+
+        int was_opaque = -1; // 0:false, 1:true, -1:not applicable
+        for (unsigned y = top_y; static_cast<int>(y) >= static_cast<int>(bottom_y); --y) // Signed as y wraps around below 0
+        {
+            if (range_limit >= 0 && get_distance(static_cast<int>(x), static_cast<int>(y)) > range_limit)
+            {
+                continue;
+            }
+
+            const bool opaque = is_opaque(octant, x, y);
+            const bool visible = opaque || ((y != top_y || top.Greater(y * 4 - 1, x * 4 + 1)) && (y != bottom_y || bottom.Less(y * 4 + 1, x * 4 - 1)));
+            if (visible)
+            {
+                set_visible(octant.get_x(x, y), octant.get_y(x, y));
+            }
+
+            if (x == static_cast<unsigned>(range_limit))
+            {
+                continue; // Last column, the vectors no longer matter
+            }
+
+            if (opaque)
+            {
+                if (was_opaque == 0)
+                {
+                    // Clear to opaque: the part below continues as its own sector in the next column
+                    unsigned nx = x * 2;
+                    const unsigned ny = y * 2 + 1;
+                    if (is_opaque(octant, x, y + 1)) { --nx; }
+                    if (top.Greater(ny, nx))
+                    {
+                        if (y == bottom_y) { bottom = Slope(ny, nx); break; }
+                        sectors.push_back({x + 1, top, Slope(ny, nx)});
+                    }
+                    else if (y == bottom_y)
+                    {
+                        return;
+                    }
+                }
+                was_opaque = 1;
+            }
+            else
+            {
+                if (was_opaque > 0)
+                {
+                    // Opaque to clear: lower the top vector below the wall
+                    unsigned nx = x * 2;
+                    const unsigned ny = y * 2 + 1;
+                    if (is_opaque(octant, x + 1, y + 1)) { ++nx; }
+                    if (bottom.GreaterOrEqual(ny, nx)) { return; }
+                    top = Slope(ny, nx);
+                }
+                was_opaque = 0;
+            }
+        }
+
+        // Only a column ending in a clear tile leaves anything to trace in the next one
+        if (was_opaque != 0)
+        {
+            break;
+        }
+    }
 }
@@ -0,0 +1,31 @@
+#include "LineOfSight.h"
+
+#include "Fov.h"
+
+#include <diag/Assert.h>
+#include <level/Network.h>
+
+void fov::compute_line_of_sight(const Network& network, const math::Vec2i& origin, int range, VisibilityMap& result)
+{
+    T3D_ASSERT(range >= 0);
+    result.reset(origin, static_cast<std::size_t>(range));
+
+    const BitPlane& walkable = network.get_walkable_plane();
+    auto blocks_light = [&walkable](int x, int y)
+    {
+        return !walkable.contains(x, y) || !walkable.get(x, y);
+    };
+    auto set_visible = [&result](int x, int y)
+    {
+        result.set_status({x, y}, VisibilityStatus::Visible);
+    };
+    // Only ever compared against range, so testing against the circle is enough
+    const int range_squared = range * (range + 1);
+    auto get_distance = [range, range_squared](int x, int y)
+    {
+        return x * x + y * y <= range_squared ? range : range + 1;
+    };
+
+    auto visibility = make_visibility(blocks_light, set_visible, get_distance);
+    visibility.compute(origin, OctantSet().set(), range);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "VisibilityMap.h"
+
+#include <math/Vec2.h>
+
+struct Network;
+
+namespace fov
+{
+    // Marks the tiles of network seen from origin as Visible, result is reset to cover range around origin.
+    // Light travels along nodes and connectors, empty tiles and everything outside the network block it.
+    void compute_line_of_sight(const Network& network, const math::Vec2i& origin, int range, VisibilityMap& result);
+}
@@ -1,5 +1,12 @@
 #include "VisibilityMap.h"
 
+void VisibilityMap::reset(const math::Vec2i& center, std::size_t range)
+{
+    offset.set(center.x - static_cast<int>(range), center.y - static_cast<int>(range));
+    bitmap.resize(0, 0);
+    bitmap.resize(range * 2 + 1, range * 2 + 1, VisibilityStatus::None);
+}
+
 VisibilityStatus VisibilityMap::get_status(const math::Vec2i& pos) const
 {
     const auto relative_pos = pos - offset;
@@ -13,11 +13,10 @@ enum class VisibilityStatus
 struct VisibilityMap
 {
     VisibilityMap() : bitmap(0, 0) {};
-    VisibilityMap(math::Vec2i center, std::size_t range) : offset(center), bitmap(range * 2, range * 2)
-    {
-        offset.x -= static_cast<int>(range);
-        offset.y -= static_cast<int>(range);
-    }
+    VisibilityMap(math::Vec2i center, std::size_t range) { reset(center, range); }
+
+    // Covers every tile up to range away from center, all set to None
+    void reset(const math::Vec2i& center, std::size_t range);
 
     bool is_visible(const math::Vec2i& pos) const { return get_status(pos) == VisibilityStatus::Visible; }
     VisibilityStatus get_status(const math::Vec2i& pos) const;
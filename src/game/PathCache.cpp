@@ -0,0 +1,61 @@
+#include "PathCache.h"
+
+#include <diag/Assert.h>
+
+#include <initializer_list>
+
+const std::size_t PathCache::DefaultCapacity;
+
+std::size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+    std::size_t hash = key.revision;
+    for (int value : {key.from.x, key.from.y, key.to.x, key.to.y})
+    {
+        hash = hash * 31 + static_cast<unsigned>(value);
+    }
+    return hash;
+}
+
+PathCache::Path PathCache::find(unsigned revision, const math::Vec2i& from, const math::Vec2i& to)
+{
+    auto lookup_it = lookup.find({revision, from, to});
+    if (lookup_it == lookup.end())
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, lookup_it->second);
+    return lookup_it->second->path;
+}
+
+PathCache::Path PathCache::insert(unsigned revision, const math::Vec2i& from, const math::Vec2i& to, std::vector<math::Vec2i> path)
+{
+    T3D_ASSERT(capacity > 0);
+    const Key key{revision, from, to};
+    Path shared_path = std::make_shared<const std::vector<math::Vec2i>>(std::move(path));
+
+    auto lookup_it = lookup.find(key);
+    if (lookup_it != lookup.end())
+    {
+        lookup_it->second->path = shared_path;
+        entries.splice(entries.begin(), entries, lookup_it->second);
+        return shared_path;
+    }
+
+    if (entries.size() >= capacity)
+    {
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front({key, shared_path});
+    lookup.emplace(key, entries.begin());
+    return shared_path;
+}
+
+void PathCache::clear()
+{
+    entries.clear();
+    lookup.clear();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <math/Vec2.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Least recently used paths between two nodes, for a given network revision.
+// Paths are shared and never modified once stored, so walkers can hold on to them after eviction.
+class PathCache
+{
+public:
+    using Path = std::shared_ptr<const std::vector<math::Vec2i>>;
+
+    static const std::size_t DefaultCapacity = 64;
+
+    explicit PathCache(std::size_t capacity = DefaultCapacity) : capacity(capacity) {}
+    PathCache(const PathCache&) = delete; // Lookup refers into the entry list
+    PathCache& operator=(const PathCache&) = delete;
+
+    // Returns null and counts a miss when the path is not stored
+    Path find(unsigned revision, const math::Vec2i& from, const math::Vec2i& to);
+    Path insert(unsigned revision, const math::Vec2i& from, const math::Vec2i& to, std::vector<math::Vec2i> path);
+    void clear();
+
+    std::size_t get_size() const { return entries.size(); }
+    std::size_t get_hits() const { return hits; }
+    std::size_t get_misses() const { return misses; }
+
+private:
+    struct Key
+    {
+        unsigned revision;
+        math::Vec2i from;
+        math::Vec2i to;
+
+        bool operator==(const Key& rhs) const { return revision == rhs.revision && from == rhs.from && to == rhs.to; }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Path path;
+    };
+
+    using EntryList = std::list<Entry>; // Most recently used first
+
+    std::size_t capacity;
+    EntryList entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> lookup;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
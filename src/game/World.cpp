@@ -1,25 +1,31 @@
 #include "World.h"
-#include <Direction.h>
+#include <entity/ComponentData.h>
+#include <level/NetworkTools.h>
+
+#include <algorithm>
+
+static const int EntityGridCallbackID = 1;
 
 World::SubnetConnection World::get_subnet_connections(const math::Vec2i& pos) const
 {
     auto* tile = network.get_tile(pos);
-    T3D_ASSERT(tile->type == TileType::Connector);
+    T3D_ASSERT(tile->get_type() == TileType::Connector);
     static const math::Vec2i connector_offsets[] = {
         math::Vec2i::AxisX,
         math::Vec2i::AxisY,
     };
     T3D_ASSERT(static_cast<int>(tile->connector().type) < 2); // Make sure to never exceed this array
     auto connector_offset = connector_offsets[static_cast<int>(tile->connector().type)];
-    SubnetID a = network.get_tile(pos + connector_offset)->node().subnet_id;
-    SubnetID b = network.get_tile(pos - connector_offset)->node().subnet_id;
+    const SubnetTopology& topology = network.subnet_topology;
+    SubnetID a = topology.get_node_subnet(network.get_node_index(pos + connector_offset));
+    SubnetID b = topology.get_node_subnet(network.get_node_index(pos - connector_offset));
     return {a, b};
 }
 
 bool World::is_subnet_separator(math::Vec2i pos) const
 {
-    auto connection = get_subnet_connections(pos);
-    return connection.a != connection.b;
+    T3D_ASSERT(network.get_tile(pos)->get_type() == TileType::Connector);
+    return network.is_subnet_separator(pos);
 }
 
 bool World::is_connected_to_subnet(math::Vec2i pos, SubnetID subnet) const
@@ -35,19 +41,15 @@ bool World::is_connected_to_visible_node(math::Vec2i pos) const
     {
         std::vector<math::Vec2i> test_sites;
         auto* tile = network.get_tile(pos);
-        if (tile->type == TileType::Node)
+        if (tile->get_type() == TileType::Node)
         {
             test_sites.reserve(4);
-            for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+            network.for_each_neighbour(network.get_node_index(pos), [this, &test_sites](NodeIndex neighbour)
             {
-                auto delta = Direction::to_vec2i(dir);
-                if (network.get_tile(pos + delta)->type == TileType::Connector)
-                {
-                    test_sites.emplace_back(pos + delta * 2);
-                }
-            }
+                test_sites.emplace_back(network.get_node_pos(neighbour));
+            });
         }
-        else if (tile->type == TileType::Connector)
+        else if (tile->get_type() == TileType::Connector)
         {
             test_sites.reserve(2);
             if (tile->connector().type == ConnectorType::Horizontal)
@@ -83,7 +85,7 @@ void World::update_visibility_map()
         {
             math::Vec2i pos{x, y};
             auto* tile = network.get_tile(pos);
-            if (tile->type == TileType::Node && known_subnets[tile->node().subnet_id])
+            if (tile->get_type() == TileType::Node && known_subnets[tile->node().subnet_id])
             {
                 visibility_map.at(x, y) = Visibility::Visible;
             }
@@ -102,3 +104,62 @@ void World::update_visibility_map()
         }
     }
 }
+
+void World::set_position(ecs::EntityFacade& entity, const math::Vec2i& pos)
+{
+    auto* position = entity.get_component<Position>();
+    T3D_ASSERT(position);
+    position->pos = pos;
+    entity_grid.move(entity.entity_id(), pos);
+}
+
+PathCache::Path World::find_path(const math::Vec2i& from, const math::Vec2i& to)
+{
+    PathCache::Path path = path_cache.find(network.revision, from, to);
+    if (!path)
+    {
+        path = path_cache.insert(network.revision, from, to, networktools::find_path(network, from, to));
+    }
+    return path;
+}
+
+const networktools::DistanceField& World::get_distance_field(const math::Vec2i& target)
+{
+    auto field_it = std::find_if(distance_fields.begin(), distance_fields.end(), [&target](const networktools::DistanceField& field)
+    {
+        return field.get_target() == target;
+    });
+
+    if (field_it == distance_fields.end())
+    {
+        if (distance_fields.size() < MaxDistanceFields)
+        {
+            distance_fields.emplace_back();
+        }
+        field_it = distance_fields.end() - 1; // Reuse the least recently used field
+        field_it->build(network, target);
+    }
+
+    std::rotate(distance_fields.begin(), field_it, field_it + 1);
+    return distance_fields.front();
+}
+
+void World::track_entity_positions()
+{
+    entities.on_component_added_event.add(EntityGridCallbackID, ecs::Aspect::all_with<Position>(), [this](ecs::EntityFacade entity)
+    {
+        // Called for every component added to a positioned entity, only the first one matters
+        if (!entity_grid.contains(entity.entity_id()))
+        {
+            entity_grid.insert(entity.entity_id(), entity.get_component<Position>()->pos);
+        }
+    });
+    entities.on_component_removed_event.add(EntityGridCallbackID, ecs::Aspect::all_with<Position>(), [this](ecs::EntityFacade entity)
+    {
+        // Also called when other components are removed, or the entity is destroyed
+        if (!entity.has_component<Position>())
+        {
+            entity_grid.remove(entity.entity_id());
+        }
+    });
+}
@@ -2,6 +2,9 @@
 
 #include <Random.h>
 #include <ecs/ECS.h>
+#include <ecs/SpatialGrid.h>
+#include <game/PathCache.h>
+#include <level/DistanceField.h>
 #include <level/Network.h>
 
 enum class Visibility
@@ -35,6 +38,8 @@ public:
     Array2<Visibility> visibility_map;
     Network network;
     ecs::ECS entities;
+    ecs::SpatialGrid entity_grid; // Entities with a Position, by tile
+    PathCache path_cache;
     Random gameplay_rng;
 
     void reset();
@@ -43,12 +48,21 @@ public:
     bool is_subnet_separator(math::Vec2i pos) const;
     bool is_connected_to_subnet(math::Vec2i pos, SubnetID subnet) const;
     bool can_leave() const { return exit_strength <= 0; }
+    void set_position(ecs::EntityFacade& entity, const math::Vec2i& pos);
+    // Cached in path_cache, empty when to cannot be reached
+    PathCache::Path find_path(const math::Vec2i& from, const math::Vec2i& to);
+    // Shared by every agent heading to target, kept for the most recently requested targets
+    const networktools::DistanceField& get_distance_field(const math::Vec2i& target);
 
     void update_visibility_map();
 
 private:
     SubnetConnection get_subnet_connections(const math::Vec2i& pos) const;
     bool is_connected_to_visible_node(math::Vec2i pos) const;
+    void track_entity_positions();
+
+    static const std::size_t MaxDistanceFields = 4;
+    std::vector<networktools::DistanceField> distance_fields; // Most recently used first
 };
 
 inline void World::reset()
@@ -72,4 +86,8 @@ inline void World::reset_level()
     visibility_map.resize(0,0);
     network = Network();
     entities = ecs::ECS();
+    entity_grid.reset(0, 0);
+    path_cache.clear(); // Paths of the old network can no longer be hit, free them
+    distance_fields.clear();
+    track_entity_positions();
 }
@@ -0,0 +1,75 @@
+#include "DistanceField.h"
+
+#include <diag/Assert.h>
+
+const unsigned networktools::DistanceField::Unreachable;
+
+void networktools::DistanceField::build(const Network& network, const math::Vec2i& target)
+{
+    const NodeIndex target_node = network.get_node_index(target);
+    T3D_ASSERT(target_node != NodeIndexNull);
+    this->target = target;
+    distances.assign(network.get_node_count(), Unreachable);
+
+    std::vector<NodeIndex> queue;
+    queue.reserve(network.get_node_count());
+    queue.push_back(target_node);
+    distances[target_node] = 0;
+    for (std::size_t queue_index = 0; queue_index < queue.size(); ++queue_index)
+    {
+        const NodeIndex current = queue[queue_index];
+        const unsigned next_distance = distances[current] + 1;
+        network.for_each_neighbour(current, [this, &queue, next_distance](NodeIndex neighbour)
+        {
+            if (distances[neighbour] == Unreachable)
+            {
+                distances[neighbour] = next_distance;
+                queue.push_back(neighbour);
+            }
+        });
+    }
+}
+
+void networktools::DistanceField::clear()
+{
+    distances.clear();
+}
+
+NodeIndex networktools::DistanceField::get_next_node(const Network& network, NodeIndex node) const
+{
+    T3D_ASSERT(distances.size() == network.get_node_count());
+    const unsigned distance = distances[node];
+    if (distance == 0 || distance == Unreachable)
+    {
+        return NodeIndexNull;
+    }
+
+    // Neighbours come in direction order, so every agent breaks ties the same way
+    for (const NodeIndex* it = network.neighbours_begin(node), *end = network.neighbours_end(node); it != end; ++it)
+    {
+        if (distances[*it] == distance - 1)
+        {
+            return *it;
+        }
+    }
+    T3D_FAIL("Distance field does not match network");
+    return NodeIndexNull;
+}
+
+std::vector<math::Vec2i> networktools::DistanceField::get_path(const Network& network, const math::Vec2i& start) const
+{
+    NodeIndex node = network.get_node_index(start);
+    T3D_ASSERT(node != NodeIndexNull);
+    if (distances[node] == Unreachable)
+    {
+        return {};
+    }
+
+    std::vector<math::Vec2i> path;
+    path.reserve(distances[node] + 1);
+    for (; node != NodeIndexNull; node = get_next_node(network, node))
+    {
+        path.push_back(network.get_node_pos(node));
+    }
+    return path;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <level/Network.h>
+#include <math/Vec2.h>
+
+#include <vector>
+
+namespace networktools
+{
+    // Node distances towards a single target, found with one search over the network.
+    // Any number of agents can head for the target by repeatedly stepping to a neighbour closer to it.
+    class DistanceField
+    {
+    public:
+        static const unsigned Unreachable = static_cast<unsigned>(-1);
+
+        void build(const Network& network, const math::Vec2i& target);
+        void clear();
+
+        bool is_built() const { return !distances.empty(); }
+        const math::Vec2i& get_target() const { return target; }
+        unsigned get_distance(NodeIndex node) const { return distances[node]; }
+        // Neighbour one step closer to the target, NodeIndexNull at the target or when it cannot be reached
+        NodeIndex get_next_node(const Network& network, NodeIndex node) const;
+        // Nodes from start up to and including the target, empty when the target cannot be reached
+        std::vector<math::Vec2i> get_path(const Network& network, const math::Vec2i& start) const;
+
+    private:
+        math::Vec2i target;
+        std::vector<unsigned> distances; // Per NodeIndex
+    };
+}
@@ -0,0 +1,112 @@
+#include "LevelBatch.h"
+
+#include "DistanceField.h"
+#include "Network.h"
+
+#include <diag/Assert.h>
+#include <math/Math_misc.h>
+#include <os/WorkerPool.h>
+
+#include <chrono>
+
+namespace
+{
+
+inline bool in_range(unsigned value, const Rangei& range)
+{
+    return static_cast<long long>(range.min) <= value && value <= static_cast<long long>(range.max);
+}
+
+void generate_seeds(int first_seed, std::size_t first_index, std::size_t last_index, const networkgenerator::Settings& settings, levelbatch::BatchResult& result, networkgenerator::PassTimings& timings)
+{
+    // Reused between seeds to keep allocations down
+    Network network;
+    for (std::size_t index = first_index; index < last_index; ++index)
+    {
+        const int seed = first_seed + static_cast<int>(index);
+        networkgenerator::generate(seed, settings, &network, &timings);
+        result.levels[index] = levelbatch::get_stats(seed, network);
+    }
+}
+
+}
+
+bool levelbatch::Constraints::matches(const LevelStats& stats) const
+{
+    return in_range(stats.subnet_count, subnet_count)
+        && in_range(stats.data_store_count, data_store_count)
+        && in_range(stats.patrol_count, patrol_count)
+        && in_range(stats.exit_distance, exit_distance)
+        && in_range(stats.furthest_data_store_distance, furthest_data_store_distance);
+}
+
+levelbatch::LevelStats levelbatch::get_stats(int seed, const Network& network)
+{
+    LevelStats stats;
+    stats.seed = seed;
+    stats.node_count = network.get_node_count();
+    stats.subnet_count = network.subnet_count;
+    stats.patrol_count = static_cast<unsigned>(network.patrolling_enemies.size());
+
+    // Distances are symmetric, so one search from the entrance covers every node of interest
+    networktools::DistanceField field;
+    field.build(network, network.entrance);
+    stats.exit_distance = field.get_distance(network.get_node_index(network.exit));
+    for (NodeIndex node = 0; node < network.get_node_count(); ++node)
+    {
+        if (network.get_tile(network.get_node_pos(node))->node().type != NodeType::DataStore)
+        {
+            continue;
+        }
+
+        const unsigned distance = field.get_distance(node);
+        stats.nearest_data_store_distance = stats.data_store_count == 0 ? distance : math::min(stats.nearest_data_store_distance, distance);
+        stats.furthest_data_store_distance = math::max(stats.furthest_data_store_distance, distance);
+        ++stats.data_store_count;
+    }
+    return stats;
+}
+
+levelbatch::BatchResult levelbatch::generate(int first_seed, int seed_count, const networkgenerator::Settings& settings, const Constraints& constraints, WorkerPool& workers)
+{
+    T3D_ASSERT(seed_count >= 0);
+    const auto start_time = std::chrono::steady_clock::now();
+
+    BatchResult result;
+    const std::size_t count = static_cast<std::size_t>(seed_count);
+    result.levels.resize(count);
+
+    // Small jobs keep every thread busy when some seeds take longer than others
+    const std::size_t job_count = math::min(count, math::max<std::size_t>(workers.get_thread_count(), 1) * 8);
+    std::vector<networkgenerator::PassTimings> job_timings(job_count);
+    if (job_count > 0)
+    {
+        const std::size_t seeds_per_job = (count + job_count - 1) / job_count;
+        for (std::size_t job = 0; job < job_count; ++job)
+        {
+            const std::size_t first_index = math::min(count, job * seeds_per_job);
+            const std::size_t last_index = math::min(count, first_index + seeds_per_job);
+            networkgenerator::PassTimings& timings = job_timings[job];
+            workers.submit([first_seed, first_index, last_index, &settings, &result, &timings]()
+            {
+                generate_seeds(first_seed, first_index, last_index, settings, result, timings);
+            });
+        }
+        workers.wait();
+    }
+
+    for (const auto& timings : job_timings)
+    {
+        result.pass_timings += timings;
+    }
+    for (const auto& stats : result.levels)
+    {
+        if (constraints.matches(stats))
+        {
+            result.matching_seeds.push_back(stats.seed);
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return result;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ds/Range.h>
+#include <level/NetworkGenerator.h>
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+struct Network;
+class WorkerPool;
+
+namespace levelbatch
+{
+    struct LevelStats
+    {
+        int seed = 0;
+        unsigned node_count = 0;
+        unsigned subnet_count = 0;
+        unsigned data_store_count = 0;
+        unsigned patrol_count = 0;
+        // Node steps from the entrance
+        unsigned exit_distance = 0;
+        unsigned nearest_data_store_distance = 0; // 0 without data stores
+        unsigned furthest_data_store_distance = 0;
+    };
+
+    // Inclusive ranges a level has to fall within, every level matches by default
+    struct Constraints
+    {
+        Rangei subnet_count{0, INT_MAX};
+        Rangei data_store_count{0, INT_MAX};
+        Rangei patrol_count{0, INT_MAX};
+        Rangei exit_distance{0, INT_MAX};
+        Rangei furthest_data_store_distance{0, INT_MAX};
+
+        bool matches(const LevelStats& stats) const;
+    };
+
+    struct BatchResult
+    {
+        std::vector<LevelStats> levels; // Every generated level, by seed
+        std::vector<int> matching_seeds; // Levels that met the constraints, ascending
+        networkgenerator::PassTimings pass_timings; // Summed over all levels
+        double seconds = 0.0; // Wall clock time of the whole batch
+    };
+
+    LevelStats get_stats(int seed, const Network& network);
+
+    // Generates seeds first_seed up to first_seed + seed_count, spread over the workers.
+    // Results do not depend on the number of worker threads.
+    BatchResult generate(int first_seed, int seed_count, const networkgenerator::Settings& settings, const Constraints& constraints, WorkerPool& workers);
+}
@@ -0,0 +1,57 @@
+#include "LevelPrefetcher.h"
+
+#include "NetworkGenerator.h"
+
+#include <utility>
+
+LevelPrefetcher::~LevelPrefetcher()
+{
+    join();
+}
+
+void LevelPrefetcher::request(int seed)
+{
+    join();
+    requested = true;
+    requested_seed = seed;
+#ifndef __EMSCRIPTEN__
+    // Only the background thread touches prefetched until it is joined
+    thread = std::thread([this, seed]() { prepare(seed, &prefetched, nullptr); });
+#endif
+}
+
+void LevelPrefetcher::take(int seed, Network* network, WorkerPool* workers)
+{
+    join();
+#ifndef __EMSCRIPTEN__
+    if (requested && requested_seed == seed)
+    {
+        requested = false;
+        *network = std::move(prefetched);
+        prefetched = Network();
+        return;
+    }
+#endif
+
+    requested = false;
+    prepare(seed, network, workers);
+}
+
+void LevelPrefetcher::prepare(int seed, Network* network, WorkerPool* workers)
+{
+    networkgenerator::generate(seed, network);
+    if (!network->distance_table.build(*network, workers))
+    {
+        network->subnet_paths.build(*network); // Too big for a table, search per subnet instead
+    }
+}
+
+void LevelPrefetcher::join()
+{
+#ifndef __EMSCRIPTEN__
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <level/Network.h>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#endif
+
+class WorkerPool;
+
+// Generates the network of an upcoming level on a background thread while the current one is played.
+// Builds without thread support generate the network when it is taken instead.
+class LevelPrefetcher
+{
+public:
+    LevelPrefetcher() {}
+    LevelPrefetcher(const LevelPrefetcher&) = delete;
+    LevelPrefetcher& operator=(const LevelPrefetcher&) = delete;
+    ~LevelPrefetcher();
+
+    // Starts generating the level for seed, an earlier request is dropped
+    void request(int seed);
+    // Moves the network for seed into network, only waits when the request for seed has not finished yet.
+    // Seeds that were not requested are generated on the spot, using workers when given.
+    void take(int seed, Network* network, WorkerPool* workers = nullptr);
+
+    // Network generation with the path finding structures the game relies on
+    static void prepare(int seed, Network* network, WorkerPool* workers);
+
+private:
+    void join();
+
+    bool requested = false;
+    int requested_seed = 0;
+    Network prefetched;
+#ifndef __EMSCRIPTEN__
+    std::thread thread;
+#endif
+};
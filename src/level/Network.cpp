@@ -1,13 +1,131 @@
 #include "Network.h"
 
+#include <Direction.h>
+
+#include <atomic>
 #include <memory>
 
+namespace
+{
+
+// Shared by every network so a revision never repeats, networks are built on worker threads too
+std::atomic<unsigned> last_revision(0);
+
+}
+
 void Network::reset(const Size2i& new_size)
 {
     size = new_size;
+    tiles.resize(0, 0);
     tiles.resize(new_size.width, new_size.height);
-    memset(tiles.data(), 0, tiles.size_in_bytes());
     patrolling_enemies.clear();
+    build_graph();
+}
+
+void Network::build_graph()
+{
+    revision = ++last_revision;
+    distance_table.clear();
+    subnet_paths.clear();
+    node_indices.resize(0, 0);
+    node_indices.resize(size.width, size.height, NodeIndexNull);
+    node_positions.clear();
+    for (int y = 0; y < size.height; ++y)
+    {
+        for (int x = 0; x < size.width; ++x)
+        {
+            if (tiles.at(x, y).get_type() == TileType::Node)
+            {
+                node_indices.at(x, y) = static_cast<NodeIndex>(node_positions.size());
+                node_positions.push_back({x, y});
+            }
+        }
+    }
+
+    node_exits.clear();
+    node_exits.reserve(node_positions.size());
+    neighbour_offsets.clear();
+    neighbour_offsets.reserve(node_positions.size() + 1);
+    neighbours.clear();
+    for (const auto& pos : node_positions)
+    {
+        neighbour_offsets.push_back(static_cast<unsigned>(neighbours.size()));
+        std::uint8_t exits = 0;
+        for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+        {
+            auto delta = Direction::to_vec2i(dir);
+            if (get_tile_safe(pos + delta)->get_type() == TileType::Connector)
+            {
+                const NodeIndex neighbour = get_node_index(pos + delta * 2);
+                T3D_ASSERT(neighbour != NodeIndexNull); // Connectors always join two nodes
+                exits |= 1 << dir;
+                neighbours.push_back(neighbour);
+            }
+        }
+        node_exits.push_back(exits);
+    }
+    neighbour_offsets.push_back(static_cast<unsigned>(neighbours.size()));
+
+    subnet_topology.build(*this);
+    build_planes();
+}
+
+void Network::build_planes()
+{
+    walkable_plane.resize(size.width, size.height);
+    node_plane.resize(size.width, size.height);
+    separator_plane.resize(size.width, size.height);
+
+    // Row order keeps the tiles and planes streaming through memory
+    for (int y = 0; y < size.height; ++y)
+    {
+        for (int x = 0; x < size.width; ++x)
+        {
+            const TileType type = tiles.at(x, y).get_type();
+            if (type == TileType::Node)
+            {
+                walkable_plane.set(x, y);
+                node_plane.set(x, y);
+            }
+            else if (type == TileType::Connector)
+            {
+                walkable_plane.set(x, y);
+            }
+        }
+    }
+
+    for (std::size_t subnet = 0; subnet < subnet_topology.get_subnet_count(); ++subnet)
+    {
+        const ArrayView<const SubnetTopology::Link> links = subnet_topology.get_links(subnet);
+        for (std::size_t link_index = 0; link_index < links.get_size(); ++link_index)
+        {
+            const ArrayView<const math::Vec2i> link_separators = subnet_topology.get_separators(links[link_index]);
+            for (std::size_t index = 0; index < link_separators.get_size(); ++index)
+            {
+                separator_plane.set(link_separators[index].x, link_separators[index].y);
+            }
+        }
+    }
+}
+
+void Network::get_subnet_plane(SubnetID subnet, BitPlane& result) const
+{
+    result.resize(size.width, size.height);
+    const ArrayView<const unsigned> nodes = subnet_topology.get_nodes(subnet);
+    for (std::size_t index = 0; index < nodes.get_size(); ++index)
+    {
+        const NodeIndex node = nodes[index];
+        const math::Vec2i& pos = node_positions[node];
+        result.set(pos.x, pos.y);
+        for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+        {
+            if ((node_exits[node] & (1 << dir)) && subnet_topology.get_node_subnet(get_neighbour(node, static_cast<Direction::Type>(dir))) == subnet)
+            {
+                const math::Vec2i connector_pos = pos + Direction::to_vec2i(dir);
+                result.set(connector_pos.x, connector_pos.y);
+            }
+        }
+    }
 }
 
 const Tile* Network::get_tile_safe(const math::Vec2i& pos) const
@@ -18,8 +136,8 @@ const Tile* Network::get_tile_safe(const math::Vec2i& pos) const
     }
     else
     {
-        static Tile empty_tile;
-        empty_tile.type = TileType::Empty;
+        // Never written, so threads generating networks concurrently can share it
+        static const Tile empty_tile;
         return &empty_tile;
     }
 }
@@ -1,17 +1,28 @@
 #pragma once
 
+#include "NetworkDistanceTable.h"
+#include "NodeIndex.h"
+#include "SubnetPathFinder.h"
+#include "SubnetTopology.h"
+
+#include <Direction.h>
 #include <ds/Array2.h>
+#include <ds/BitPlane.h>
 #include <ds/Size2.h>
 #include <math/Vec2.h>
 
-enum class TileType
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+enum class TileType : std::uint8_t
 {
     Empty,
     Node,
     Connector,
 };
 
-enum class NodeType
+enum class NodeType : std::uint8_t
 {
     Normal,
     Entrance,
@@ -19,7 +30,7 @@ enum class NodeType
     DataStore,
 };
 
-using SubnetID = std::size_t;
+using SubnetID = unsigned;
 static const SubnetID SubnetIDNull = 0xFFFFFFFF;
 
 struct NodeData
@@ -28,7 +39,7 @@ struct NodeData
     NodeType type;
 };
 
-enum class ConnectorType
+enum class ConnectorType : std::uint8_t
 {
     Horizontal,
     Vertical,
@@ -39,23 +50,49 @@ struct ConnectorData
     ConnectorType type;
 };
 
+// Packed into 32 bits so large networks stay cache friendly, node() and connector() unpack a copy
 struct Tile
 {
-    TileType type = TileType::Empty;
+    static const SubnetID MaxSubnetCount = 1u << 24;
 
-    NodeData& node() { T3D_ASSERT(type == TileType::Node); return data.node; }
-    const NodeData& node() const { T3D_ASSERT(type == TileType::Node); return data.node; }
-    ConnectorData& connector() { T3D_ASSERT(type == TileType::Connector); return data.connector; }
-    const ConnectorData& connector() const { T3D_ASSERT(type == TileType::Connector); return data.connector; }
+    TileType get_type() const { return static_cast<TileType>(bits & TypeMask); }
+    NodeData node() const { T3D_ASSERT(get_type() == TileType::Node); return {bits >> SubnetShift, static_cast<NodeType>((bits >> KindShift) & KindMask)}; }
+    ConnectorData connector() const { T3D_ASSERT(get_type() == TileType::Connector); return {static_cast<ConnectorType>((bits >> KindShift) & KindMask)}; }
+
+    void set_empty() { bits = 0; }
+    void set_node(SubnetID subnet, NodeType type = NodeType::Normal);
+    void set_node_type(NodeType type);
+    void set_connector(ConnectorType type);
 
 private:
-    union
-    {
-        NodeData node;
-        ConnectorData connector;
-    } data;
+    // Bits 0-1 hold the TileType, 2-3 the NodeType or ConnectorType and 8-31 the subnet of a node
+    static const std::uint32_t TypeMask = 0x3;
+    static const unsigned KindShift = 2;
+    static const std::uint32_t KindMask = 0x3;
+    static const unsigned SubnetShift = 8;
+
+    std::uint32_t bits = 0;
 };
 
+static_assert(sizeof(Tile) == 4, "Tile must stay packed");
+
+inline void Tile::set_node(SubnetID subnet, NodeType type)
+{
+    T3D_ASSERT(subnet < MaxSubnetCount);
+    bits = (subnet << SubnetShift) | (static_cast<std::uint32_t>(type) << KindShift) | static_cast<std::uint32_t>(TileType::Node);
+}
+
+inline void Tile::set_node_type(NodeType type)
+{
+    T3D_ASSERT(get_type() == TileType::Node);
+    bits = (bits & ~(KindMask << KindShift)) | (static_cast<std::uint32_t>(type) << KindShift);
+}
+
+inline void Tile::set_connector(ConnectorType type)
+{
+    bits = (static_cast<std::uint32_t>(type) << KindShift) | static_cast<std::uint32_t>(TileType::Connector);
+}
+
 struct PatrollingEnemy
 {
     math::Vec2i point_a;
@@ -67,13 +104,81 @@ struct Network
     void reset(const Size2i& new_size);
     Tile* get_tile(const math::Vec2i& pos) { return &tiles.at(pos.x, pos.y); }
     const Tile* get_tile(const math::Vec2i& pos) const { return &tiles.at(pos.x, pos.y); }
-    Tile* get_tile_safe(const math::Vec2i& pos) { return const_cast<Tile*>(const_cast<const Network*>(this)->get_tile_safe(pos)); } // Cast away const so we can share implementation
+    // Tiles outside the network read as one shared empty tile, so it is only handed out read-only
     const Tile* get_tile_safe(const math::Vec2i& pos) const;
 
+    // Node adjacency, must be rebuilt whenever nodes or connectors change
+    void build_graph();
+    std::size_t get_node_count() const { return node_positions.size(); }
+    NodeIndex get_node_index(const math::Vec2i& pos) const { return node_indices.at(pos.x, pos.y); }
+    const math::Vec2i& get_node_pos(NodeIndex node) const { return node_positions[node]; }
+    unsigned get_node_exits(NodeIndex node) const { return node_exits[node]; } // Bit per Direction::Type with a connector
+    const NodeIndex* neighbours_begin(NodeIndex node) const { return neighbours.data() + neighbour_offsets[node]; }
+    const NodeIndex* neighbours_end(NodeIndex node) const { return neighbours.data() + neighbour_offsets[node + 1]; }
+    NodeIndex get_neighbour(NodeIndex node, Direction::Type dir) const;
+    // Never more than the node steps between two nodes, as a path finding heuristic
+    float get_estimated_steps(NodeIndex from, NodeIndex to) const;
+    template<typename CallbackType>
+    void for_each_neighbour(NodeIndex node, CallbackType callback) const;
+
+    // Tile bit planes, built along with the graph
+    const BitPlane& get_walkable_plane() const { return walkable_plane; } // Nodes and connectors
+    const BitPlane& get_node_plane() const { return node_plane; }
+    // Nodes of the subnet and the connectors between them
+    void get_subnet_plane(SubnetID subnet, BitPlane& result) const;
+    // Connectors between two subnets
+    bool is_subnet_separator(const math::Vec2i& pos) const { return separator_plane.get(pos.x, pos.y); }
+
     Size2i size;
     Array2<Tile> tiles;
     unsigned subnet_count = 0;
     math::Vec2i entrance;
     math::Vec2i exit;
     std::vector<PatrollingEnemy> patrolling_enemies;
+    unsigned revision = 0; // Unique to each build of the graph, across every network
+    SubnetTopology subnet_topology; // Rebuilt along with the graph
+    // Opt-in path finding structures, empty until built and cleared whenever the graph is rebuilt
+    NetworkDistanceTable distance_table;
+    SubnetPathFinder subnet_paths;
+
+private:
+    void build_planes();
+
+    // Compressed sparse rows, neighbours of a node are ordered by direction
+    Array2<NodeIndex> node_indices; // NodeIndexNull for tiles that are not nodes
+    std::vector<math::Vec2i> node_positions;
+    std::vector<std::uint8_t> node_exits;
+    std::vector<unsigned> neighbour_offsets; // Node count + 1 entries
+    std::vector<NodeIndex> neighbours;
+
+    BitPlane walkable_plane;
+    BitPlane node_plane;
+    BitPlane separator_plane;
 };
+
+inline float Network::get_estimated_steps(NodeIndex from, NodeIndex to) const
+{
+    // Every step covers a connector and a node, so two tiles per step
+    const math::Vec2i delta = node_positions[to] - node_positions[from];
+    return static_cast<float>(std::abs(delta.x) + std::abs(delta.y)) * 0.5f;
+}
+
+inline NodeIndex Network::get_neighbour(NodeIndex node, Direction::Type dir) const
+{
+    const unsigned exits = node_exits[node];
+    T3D_ASSERT(exits & (1u << dir));
+    // Neighbours are stored in direction order, skip one for every exit before dir
+    const unsigned preceding_exits = exits & ((1u << dir) - 1);
+    const unsigned slot = (preceding_exits & 1) + ((preceding_exits >> 1) & 1) + ((preceding_exits >> 2) & 1);
+    return neighbours[neighbour_offsets[node] + slot];
+}
+
+template<typename CallbackType>
+void Network::for_each_neighbour(NodeIndex node, CallbackType callback) const
+{
+    T3D_ASSERT(node < get_node_count());
+    for (const NodeIndex* it = neighbours_begin(node), *end = neighbours_end(node); it != end; ++it)
+    {
+        callback(*it);
+    }
+}
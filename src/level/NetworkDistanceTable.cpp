@@ -0,0 +1,96 @@
+#include "NetworkDistanceTable.h"
+
+#include <diag/Assert.h>
+#include <level/Network.h>
+#include <math/Math_misc.h>
+#include <os/WorkerPool.h>
+
+namespace
+{
+
+Direction::Type get_direction(const math::Vec2i& from, const math::Vec2i& to)
+{
+    const auto delta = to - from;
+    for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+    {
+        if (Direction::to_vec2i(dir) * 2 == delta)
+        {
+            return static_cast<Direction::Type>(dir);
+        }
+    }
+    T3D_FAIL("Nodes are not adjacent");
+    return Direction::First;
+}
+
+}
+
+const std::size_t NetworkDistanceTable::DefaultMaxNodeCount;
+const unsigned NetworkDistanceTable::Unreachable;
+const unsigned NetworkDistanceTable::MaxDistance;
+
+bool NetworkDistanceTable::build(const Network& network, WorkerPool* workers, std::size_t max_node_count)
+{
+    clear();
+    const std::size_t count = network.get_node_count();
+    if (count == 0 || count > max_node_count)
+    {
+        return false;
+    }
+
+    node_count = count;
+    distances.assign(count * count, static_cast<std::uint8_t>(Unreachable));
+    next_hops.resize(count * count);
+
+    if (!workers)
+    {
+        build_rows(network, 0, static_cast<unsigned>(count));
+        return true;
+    }
+
+    // A few jobs per thread so uneven rows still balance out
+    const std::size_t job_count = math::min(count, math::max<std::size_t>(workers->get_thread_count(), 1) * 4);
+    const std::size_t rows_per_job = (count + job_count - 1) / job_count;
+    for (std::size_t first_row = 0; first_row < count; first_row += rows_per_job)
+    {
+        const unsigned first_target = static_cast<unsigned>(first_row);
+        const unsigned last_target = static_cast<unsigned>(math::min(first_row + rows_per_job, count));
+        workers->submit([this, &network, first_target, last_target]() { build_rows(network, first_target, last_target); });
+    }
+    workers->wait();
+    return true;
+}
+
+void NetworkDistanceTable::clear()
+{
+    node_count = 0;
+    distances.clear();
+    next_hops.clear();
+}
+
+void NetworkDistanceTable::build_rows(const Network& network, unsigned first_target, unsigned last_target)
+{
+    std::vector<NodeIndex> queue;
+    queue.reserve(node_count);
+    for (unsigned target = first_target; target < last_target; ++target)
+    {
+        // Searching outwards from the target, every node steps towards the node it was reached from
+        std::uint8_t* row_distances = &distances[get_index(0, target)];
+        std::uint8_t* row_next_hops = &next_hops[get_index(0, target)];
+        queue.clear();
+        queue.push_back(target);
+        row_distances[target] = 0;
+        for (std::size_t queue_index = 0; queue_index < queue.size(); ++queue_index)
+        {
+            const NodeIndex current = queue[queue_index];
+            const unsigned next_distance = math::min(row_distances[current] + 1u, MaxDistance);
+            network.for_each_neighbour(current, [&](NodeIndex neighbour)
+            {
+                if (row_distances[neighbour] != Unreachable) { return; }
+
+                row_distances[neighbour] = static_cast<std::uint8_t>(next_distance);
+                row_next_hops[neighbour] = static_cast<std::uint8_t>(get_direction(network.get_node_pos(neighbour), network.get_node_pos(current)));
+                queue.push_back(neighbour);
+            });
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Direction.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class WorkerPool;
+struct Network;
+
+// Shortest node distances and first steps between every pair of nodes of a network.
+// Memory grows with the square of the node count, so networks above the build limit keep the table empty.
+class NetworkDistanceTable
+{
+public:
+    static const std::size_t DefaultMaxNodeCount = 1024;
+    static const unsigned Unreachable = 0xFF;
+    static const unsigned MaxDistance = Unreachable - 1; // Longer distances are clamped
+
+    // Spreads the per-node searches over the workers when given, returns false when the network is too big
+    bool build(const Network& network, WorkerPool* workers = nullptr, std::size_t max_node_count = DefaultMaxNodeCount);
+    void clear();
+
+    bool is_built() const { return node_count > 0; }
+    std::size_t get_node_count() const { return node_count; }
+    unsigned get_distance(unsigned from, unsigned to) const { return distances[get_index(from, to)]; }
+    // Direction of the first connector on a shortest path, only valid when to can be reached and differs from from
+    Direction::Type get_next_hop(unsigned from, unsigned to) const { return static_cast<Direction::Type>(next_hops[get_index(from, to)]); }
+
+private:
+    // Rows hold every start node for a single target, so walking a path stays within one row
+    std::size_t get_index(unsigned from, unsigned to) const { return static_cast<std::size_t>(to) * node_count + from; }
+    void build_rows(const Network& network, unsigned first_target, unsigned last_target);
+
+    std::size_t node_count = 0;
+    std::vector<std::uint8_t> distances;
+    std::vector<std::uint8_t> next_hops; // Direction::Type per entry
+};
@@ -8,14 +8,18 @@
 #include <RangeUtil.h>
 #include <Util.h>
 #include <algorithm/MazeGenerator.h>
-#include <algorithm/PathFinder.h>
+#include <diag/Assert.h>
 #include <ds/Range.h>
 #include <ds/Rect.h>
 #include <math/Math_misc.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <functional>
 
 struct ExitSpec
 {
@@ -29,23 +33,55 @@ struct ExitSpec
     ConnectorType connector_type = ConnectorType::Horizontal;
 };
 
-struct MazeWalker : public pathfinder::GraphWalker
+struct MazeWalker
 {
     using Cell = maze::Cell;
-    using NodeList = pathfinder::NodeList;
-    using NodeID = pathfinder::NodeID;
+    using NodeID = std::size_t;
     using Maze = Array2<maze::Cell>;
 
     Maze* maze_ptr = nullptr;
 
-    inline NodeID get_adjacent(NodeID current, Direction::Type dir) const
+    // Longest path has_path_within searches for
+    static const std::size_t MaxSearchLength = 32;
+
+    // Must be called while the maze is still a tree, as straight out of maze::generate
+    void reset(Maze* maze)
     {
-        return get_adjacent(maze_ptr->at(current), dir);
+        maze_ptr = maze;
+        for (int exit_index = 0; exit_index < Direction::Count; ++exit_index)
+        {
+            math::Vec2i delta = Direction::to_vec2i(static_cast<Direction::Type>(exit_index));
+            index_offsets[exit_index] = delta.x + delta.y * static_cast<std::ptrdiff_t>(maze->width());
+        }
+
+        words_per_row = (maze->width() + ExitWordBits - 1) / ExitWordBits;
+        east_exits.assign(words_per_row * maze->height(), 0);
+        south_exits.assign(words_per_row * maze->height(), 0);
+        tree.resize(maze->size());
+        for (NodeID id = 0; id < maze->size(); ++id)
+        {
+            const Cell& cell = maze->at(id);
+            tree[id] = TreeNode{id, cell.distance_from_origin};
+            if (cell.exits[Direction::East]) { set_exit_bit(&east_exits, cell.x, cell.y); }
+            if (cell.exits[Direction::South]) { set_exit_bit(&south_exits, cell.x, cell.y); }
+            for (int exit_index = 0; exit_index < Direction::Count; ++exit_index)
+            {
+                if (cell.exits[exit_index])
+                {
+                    const NodeID adjacent = get_adjacent(id, static_cast<Direction::Type>(exit_index));
+                    if (maze->at(adjacent).distance_from_origin + 1 == cell.distance_from_origin)
+                    {
+                        tree[id].parent = adjacent;
+                        break;
+                    }
+                }
+            }
+        }
     }
 
     inline NodeID get_cell_id(const Cell& cell) const
     {
-        return static_cast<NodeID>(maze_ptr->get_index(cell.x, cell.y));
+        return maze_ptr->get_index(cell.x, cell.y);
     }
 
     inline Cell* get_cell(NodeID id)
@@ -58,11 +94,6 @@ struct MazeWalker : public pathfinder::GraphWalker
         return &maze_ptr->at(id);
     }
 
-    inline NodeList find_path(NodeID start, NodeID end) const
-    {
-        return pathfinder::find_path(*this, start, end);
-    }
-
     bool try_get_adjacent(const Cell& current, Direction::Type dir, NodeID* id) const
     {
         math::Vec2i delta = Direction::to_vec2i(dir);
@@ -70,7 +101,7 @@ struct MazeWalker : public pathfinder::GraphWalker
         Maze::size_type adj_y = current.y + delta.y;
         if (maze_ptr->contains(adj_x, adj_y))
         {
-            *id = static_cast<NodeID>(maze_ptr->get_index(adj_x, adj_y));
+            *id = maze_ptr->get_index(adj_x, adj_y);
             return true;
         }
         else
@@ -79,74 +110,200 @@ struct MazeWalker : public pathfinder::GraphWalker
         }
     }
 
-    NodeID get_adjacent(const Cell& current, Direction::Type dir) const
+    // Only for directions that stay within the maze
+    inline NodeID get_adjacent(NodeID id, Direction::Type dir) const
     {
-        math::Vec2i delta = Direction::to_vec2i(dir);
-        Maze::size_type adj_x = current.x + delta.x;
-        Maze::size_type adj_y = current.y + delta.y;
-        return static_cast<NodeID>(maze_ptr->get_index(adj_x, adj_y));
+        return id + index_offsets[dir];
     }
 
-    virtual NodeList get_neighbours(NodeID id) const override
+    inline NodeID get_adjacent(const Cell& current, Direction::Type dir) const
     {
-        const auto* cell = get_cell(id);
-        NodeList list;
-        list.reserve(Direction::Count);
-        for (int exit_index = 0; exit_index < Direction::Count; ++exit_index)
+        return get_adjacent(get_cell_id(current), dir);
+    }
+
+    // Adds an exit to both cells, use instead of changing Cell::exits once the walker is reset
+    void connect(NodeID id, Direction::Type dir)
+    {
+        const NodeID adjacent = get_adjacent(id, dir);
+        Cell& cell = maze_ptr->at(id);
+        Cell& adjacent_cell = maze_ptr->at(adjacent);
+        cell.exits[dir] = true;
+        adjacent_cell.exits[Direction::get_opposite(dir)] = true;
+
+        // Only the east and south exits are kept, a west or north exit is that of the adjacent cell
+        const bool horizontal = dir == Direction::East || dir == Direction::West;
+        const Cell& west_cell = dir == Direction::East || dir == Direction::South ? cell : adjacent_cell;
+        set_exit_bit(horizontal ? &east_exits : &south_exits, west_cell.x, west_cell.y);
+    }
+
+    // Whether a path of at most max_length cells connects start and end.
+    // Such a path stays within max_length - 1 cells of start on both axes, the search keeps a word of reached cells
+    // for every row of that window and moves all of a row one step at once.
+    bool has_path_within(NodeID start, NodeID end, std::size_t max_length) const
+    {
+        T3D_ASSERT(max_length <= MaxSearchLength);
+        if (max_length == 0) { return false; }
+
+        const int max_steps = static_cast<int>(max_length) - 1;
+        const int window_width = max_steps * 2 + 1;
+        const Cell& start_cell = maze_ptr->at(start);
+        const Cell& end_cell = maze_ptr->at(end);
+        const int window_x = static_cast<int>(start_cell.x) - max_steps;
+        const int window_y = static_cast<int>(start_cell.y) - max_steps;
+        const int end_x = static_cast<int>(end_cell.x) - window_x;
+        const int end_y = static_cast<int>(end_cell.y) - window_y;
+        if (end_x < 0 || end_y < 0 || end_x >= window_width || end_y >= window_width)
+        {
+            return false;
+        }
+
+        ExitWord east[MaxSearchWindow];
+        ExitWord south[MaxSearchWindow];
+        ExitWord reached[MaxSearchWindow] = {};
+        ExitWord next[MaxSearchWindow] = {};
+        for (int row = 0; row < window_width; ++row)
+        {
+            east[row] = get_exit_bits(east_exits, window_x, window_y + row);
+            south[row] = get_exit_bits(south_exits, window_x, window_y + row);
+        }
+
+        // After n steps only the rows within n of the start row hold reached cells
+        const ExitWord end_bit = ExitWord(1) << end_x;
+        reached[max_steps] = ExitWord(1) << max_steps;
+        if (reached[end_y] & end_bit)
+        {
+            return true;
+        }
+        for (int steps = 1; steps <= max_steps; ++steps)
         {
-            if (cell->exits[exit_index])
+            const int first_row = max_steps - steps;
+            const int last_row = max_steps + steps;
+            for (int row = first_row; row <= last_row; ++row)
             {
-                auto dir = static_cast<Direction::Type>(exit_index);
-                list.push_back(get_adjacent(*cell, dir));
+                const ExitWord current = reached[row];
+                ExitWord grown = current | ((current & east[row]) << 1) | ((current >> 1) & east[row]);
+                if (row > first_row) { grown |= reached[row - 1] & south[row - 1]; }
+                if (row < last_row) { grown |= reached[row + 1] & south[row]; }
+                next[row] = grown;
+            }
+            if (next[end_y] & end_bit)
+            {
+                return true;
+            }
+            std::copy(next + first_row, next + last_row + 1, reached + first_row);
+        }
+        return false;
+    }
+
+    // Number of cells on the path between start and end in the original maze tree, loops added since are ignored.
+    // Stops counting past max_length.
+    std::size_t get_tree_path_length(NodeID start, NodeID end, std::size_t max_length) const
+    {
+        // The path passes through every depth between its ends
+        const unsigned start_depth = tree[start].depth;
+        const unsigned end_depth = tree[end].depth;
+        if ((start_depth > end_depth ? start_depth - end_depth : end_depth - start_depth) >= max_length)
+        {
+            return max_length + 1;
+        }
+
+        std::size_t length = 1;
+        while (start != end && length <= max_length)
+        {
+            if (tree[start].depth >= tree[end].depth)
+            {
+                start = tree[start].parent;
+            }
+            else
+            {
+                end = tree[end].parent;
             }
+            ++length;
         }
-        return list;
+        return length;
     }
 
-    virtual float get_cost(NodeID start, NodeID end) const override
+private:
+    std::ptrdiff_t index_offsets[Direction::Count] = {};
+
+    // Copy of the maze tree, packed so climbing it does not pull in whole cells
+    struct TreeNode
+    {
+        NodeID parent; // Towards the maze start, the start points to itself
+        unsigned depth; // Cell::distance_from_origin
+    };
+    std::vector<TreeNode> tree;
+
+    using ExitWord = std::uint64_t;
+    static const int ExitWordBits = 64;
+    static const std::size_t MaxSearchWindow = MaxSearchLength * 2 - 1;
+    static_assert(MaxSearchWindow <= static_cast<std::size_t>(ExitWordBits), "A row of the has_path_within window must fit in an ExitWord");
+
+    void set_exit_bit(std::vector<ExitWord>* exits, std::size_t x, std::size_t y)
     {
-        return 1; // Constant cost
+        (*exits)[y * words_per_row + x / ExitWordBits] |= ExitWord(1) << (x % ExitWordBits);
     }
 
-    virtual float get_estimated_cost(NodeID start, NodeID end) const override
+    // Exits of the cells x to x + 63 on row y, the cells outside of the maze have none
+    ExitWord get_exit_bits(const std::vector<ExitWord>& exits, int x, int y) const
     {
-        Maze::size_type start_x, start_y;
-        maze_ptr->get_pos(start, &start_x, &start_y);
-        Maze::size_type end_x, end_y;
-        maze_ptr->get_pos(end, &end_x, &end_y);
-        int distance =
-            math::squared(static_cast<int>(end_x) - static_cast<int>(start_x)) +
-            math::squared(static_cast<int>(end_y) - static_cast<int>(start_y));
-        return static_cast<float>(distance);
+        if (y < 0 || y >= static_cast<int>(maze_ptr->height())) { return 0; }
+
+        const ExitWord* row = &exits[y * words_per_row];
+        const int row_words = static_cast<int>(words_per_row);
+        auto get_word = [row, row_words](int word_index) { return word_index >= 0 && word_index < row_words ? row[word_index] : 0; };
+        const int word_index = x >= 0 ? x / ExitWordBits : -((ExitWordBits - 1 - x) / ExitWordBits); // Rounded down
+        const int shift = x - word_index * ExitWordBits;
+        const ExitWord low = get_word(word_index) >> shift;
+        return shift ? low | (get_word(word_index + 1) << (ExitWordBits - shift)) : low;
     }
+
+    // A bit per cell, each row starts a new word
+    std::size_t words_per_row = 0;
+    std::vector<ExitWord> east_exits;
+    std::vector<ExitWord> south_exits;
 };
 
-std::vector<math::Vec2i> find_nodes_in_range(math::Vec2i start, int walk_range, Network* network)
+networkgenerator::PassTimings& networkgenerator::PassTimings::operator+=(const PassTimings& rhs)
 {
-    std::vector<math::Vec2i> nodes;
-    networktools::visit_nodes(*network, start, [&nodes, walk_range](const networktools::VisitData& data)
-    {
-        if (data.distance_from_start == walk_range)
-        {
-            nodes.push_back(data.pos);
-            return networktools::CallbackResult::StopVisitor;
-        }
-        else
-        {
-            return networktools::CallbackResult::Continue;
-        }
-    });
-    return nodes;
+    blocks += rhs.blocks;
+    maze += rhs.maze;
+    loops += rhs.loops;
+    subnets += rhs.subnets;
+    render += rhs.render;
+    placement += rhs.placement;
+    return *this;
+}
+
+bool networkgenerator::Settings::is_valid() const
+{
+    return maze_size.width >= MinMazeSize && maze_size.height >= MinMazeSize
+        && cells_per_block > 0
+        && min_distance_before_creating_loop <= MazeWalker::MaxSearchLength
+        && crawler_spawn_life > 0
+        && data_stores_in_network.min >= 0 && data_stores_in_network.min < data_stores_in_network.max;
 }
 
 void networkgenerator::generate(int seed, Network* network)
 {
-    static const std::size_t min_distance_before_creating_loop = 9;
-    static const Size2i maze_size{15, 7};
-    static const int crawler_spawn_life = 5;
-    static const Rangei data_stores_in_network = {3, 8};
-    static const unsigned num_patrols = 2;
-    static const unsigned patrol_length = 4;
+    generate(seed, Settings(), network);
+}
+
+void networkgenerator::generate(int seed, const Settings& settings, Network* network, PassTimings* timings)
+{
+    static const std::size_t max_measured_loop_length = 128; // Longer loops all count as equally long
+    const Size2i& maze_size = settings.maze_size;
+    T3D_ASSERT(settings.is_valid());
+
+    auto pass_start = std::chrono::steady_clock::now();
+    auto end_pass = [&](double PassTimings::* pass)
+    {
+        if (!timings) { return; }
+
+        const auto now = std::chrono::steady_clock::now();
+        timings->*pass += std::chrono::duration<double>(now - pass_start).count();
+        pass_start = now;
+    };
 
     const std::array<ExitSpec, 4> exits =
     {
@@ -168,11 +325,15 @@ void networkgenerator::generate(int seed, Network* network)
         horizontal_axis ? maze_size.width / 2 : maze_size.width,
         vertical_axis ? maze_size.height / 2 : maze_size.height
     };
-    int block_count = block_site.width() * block_site.height() / 10;
+    // Blocks stay off the edges of the site, so narrow sites get none
+    const bool site_has_room = block_site.width() >= 3 && block_site.height() >= 3;
+    int block_count = site_has_room ? block_site.width() * block_site.height() / settings.cells_per_block : 0;
+    const int max_block_attempts = block_site.width() * block_site.height();
+    Array2<unsigned> hit_neighbours(block_site.width(), block_site.height(), 0); // Hits within one step, diagonals included
     for (int block_index = 0; block_index < block_count; ++block_index)
     {
-        unsigned neighbours = 0;
         math::Vec2i block;
+        int attempts = 0;
         do
         {
             // Place block within the designated area (but at the edges)
@@ -180,19 +341,23 @@ void networkgenerator::generate(int seed, Network* network)
                 rng.next(1, block_site.width() - 1),
                 rng.next(1, block_site.height() - 1)
             );
+            ++attempts;
+        }
+        while(hit_neighbours.at(block.x, block.y) > 1 && attempts < max_block_attempts);
 
-            neighbours = 0;
-            for (auto& existing_hit : hits)
-            {
-                if (math::distance2(existing_hit, block) <= 2)
-                {
-                    ++neighbours;
-                }
-            }
+        if (hit_neighbours.at(block.x, block.y) > 1)
+        {
+            break; // Dense settings can fill the site before every block is placed
         }
-        while(neighbours > 1);
 
         hits.emplace_back(block);
+        for (int y = block.y - 1; y <= block.y + 1; ++y)
+        {
+            for (int x = block.x - 1; x <= block.x + 1; ++x)
+            {
+                ++hit_neighbours.at(x, y);
+            }
+        }
     }
 
     if (horizontal_axis)
@@ -222,6 +387,8 @@ void networkgenerator::generate(int seed, Network* network)
         collision_map.at(hit.x, hit.y) = true;
     }
 
+    end_pass(&PassTimings::blocks);
+
     // Always start generating maze from the center, since those will never be blocked
     math::Vec2i maze_start{
         maze_size.width / 2,
@@ -229,14 +396,15 @@ void networkgenerator::generate(int seed, Network* network)
     };
     auto maze = maze::generate(collision_map, rng, maze_start);
     MazeWalker maze_walker;
-    maze_walker.maze_ptr = &maze;
+    maze_walker.reset(&maze);
 
-    // Add loops to single nodes
-    for (std::size_t y = 0; y < maze.height(); ++y)
+    end_pass(&PassTimings::maze);
+
+    // Connect each dead end to the neighbour furthest away along the maze, if no path shorter than min_distance exists
+    auto add_loops_to_dead_ends = [&](std::size_t min_distance, const std::function<bool(const maze::Cell&, Direction::Type)>& can_connect)
     {
-        for (std::size_t x = 0; x < maze.width(); ++x)
+        for (auto& cell : maze)
         {
-            auto& cell = maze.at(x, y);
             int num_exits = cell.exits[Direction::North]
                 + cell.exits[Direction::South]
                 + cell.exits[Direction::East]
@@ -247,18 +415,21 @@ void networkgenerator::generate(int seed, Network* network)
                 auto cell_id = maze_walker.get_cell_id(cell);
 
                 maze::Cell* furthest_cell = nullptr;
-                std::size_t furthest_distance = min_distance_before_creating_loop;
+                std::size_t furthest_distance = min_distance;
                 Direction::Type furthest_direction = Direction::North;
-                for (std::size_t exit_index = 0; exit_index < exits.size(); ++exit_index)
+                // Past the measured length no other neighbour can be further away
+                for (std::size_t exit_index = 0; exit_index < exits.size() && furthest_distance <= max_measured_loop_length; ++exit_index)
                 {
                     auto dir = static_cast<Direction::Type>(exit_index);
-                    pathfinder::NodeID adjacent_id = 0;
-                    if (!cell.exits[exit_index] && maze_walker.try_get_adjacent(cell, dir, &adjacent_id))
+                    MazeWalker::NodeID adjacent_id = 0;
+                    if (!cell.exits[exit_index] && maze_walker.try_get_adjacent(cell, dir, &adjacent_id)
+                        && maze_walker.get_cell(adjacent_id)->has_exit() && can_connect(cell, dir))
                     {
-                        auto path = maze_walker.find_path(cell_id, adjacent_id);
-                        if (!path.empty() && furthest_distance < path.size())
+                        // The tree path is cheap but loops added since may offer a shorter one
+                        auto distance = maze_walker.get_tree_path_length(cell_id, adjacent_id, max_measured_loop_length);
+                        if (furthest_distance < distance && !maze_walker.has_path_within(cell_id, adjacent_id, min_distance))
                         {
-                            furthest_distance = path.size();
+                            furthest_distance = distance;
                             furthest_cell = maze_walker.get_cell(adjacent_id);
                             furthest_direction = dir;
                         }
@@ -267,13 +438,15 @@ void networkgenerator::generate(int seed, Network* network)
 
                 if (furthest_cell)
                 {
-                    auto opposite_dir = Direction::get_opposite(furthest_direction);
-                    furthest_cell->exits[opposite_dir] = true;
-                    cell.exits[furthest_direction] = true;
+                    maze_walker.connect(cell_id, furthest_direction);
                 }
             }
         }
-    }
+    };
+
+    add_loops_to_dead_ends(settings.min_distance_before_creating_loop, [](const maze::Cell&, Direction::Type) { return true; });
+
+    end_pass(&PassTimings::loops);
 
     Array2<SubnetID> subnets(maze_size.width, maze_size.height, SubnetIDNull);
     struct Crawler
@@ -286,6 +459,7 @@ void networkgenerator::generate(int seed, Network* network)
     };
 
     std::vector<Crawler> crawlers;
+    std::vector<math::Vec2i> crawl_options;
     std::vector<bool> subnet_usage;
     for (auto& cell : maze)
     {
@@ -295,7 +469,7 @@ void networkgenerator::generate(int seed, Network* network)
             auto& crawler = crawlers.back();
             crawler.subnet_id = subnet_usage.size();
             subnet_usage.push_back(true);
-            crawler.life = crawler_spawn_life;
+            crawler.life = settings.crawler_spawn_life;
             crawler.x = cell.x;
             crawler.y = cell.y;
             subnets.at(crawler.x, crawler.y) = crawler.subnet_id;
@@ -316,12 +490,12 @@ void networkgenerator::generate(int seed, Network* network)
             crawler.previous_subnet_id = crawler.subnet_id;
             crawler.subnet_id = subnet_usage.size();
             subnet_usage.push_back(true);
-            crawler.life = crawler_spawn_life;
+            crawler.life = settings.crawler_spawn_life;
             subnets.at(crawler.x, crawler.y) = crawler.subnet_id;
         }
 
         maze::Cell& my_cell = maze.at(crawler.x, crawler.y);
-        std::vector<math::Vec2i> options;
+        crawl_options.clear();
         for (std::size_t exit_index = 0; exit_index < exits.size(); ++exit_index)
         {
             if (my_cell.exits[exit_index])
@@ -332,12 +506,12 @@ void networkgenerator::generate(int seed, Network* network)
                 {
                     math::Vec2i option(crawler.x, crawler.y);
                     option += delta;
-                    options.push_back(option);
+                    crawl_options.push_back(option);
                 }
             }
         }
 
-        if (options.empty() && crawler.life == crawler_spawn_life)
+        if (crawl_options.empty() && crawler.life == settings.crawler_spawn_life)
         {
             // If brand new crawler without any options, just revert to its previous subnet, to prevent single node subnets
             subnets.at(crawler.x, crawler.y) = crawler.previous_subnet_id;
@@ -345,7 +519,7 @@ void networkgenerator::generate(int seed, Network* network)
         }
         else
         {
-            for (auto& option : options)
+            for (auto& option : crawl_options)
             {
                 crawlers.push_back({});
                 auto& child = crawlers.back();
@@ -412,6 +586,8 @@ void networkgenerator::generate(int seed, Network* network)
 #endif
     }
 
+    end_pass(&PassTimings::subnets);
+
     // Connect nodes within the same subnet better
     auto same_subnet = [&](const maze::Cell& cell, Direction::Type dir)
     {
@@ -420,48 +596,9 @@ void networkgenerator::generate(int seed, Network* network)
         return subnets.at(cell.x, cell.y) == subnets.at(adj_cell->x, adj_cell->y);
     };
 
-    for (std::size_t y = 0; y < maze.height(); ++y)
-    {
-        for (std::size_t x = 0; x < maze.width(); ++x)
-        {
-            auto& cell = maze.at(x, y);
-            int num_exits = cell.exits[Direction::North]
-                + cell.exits[Direction::South]
-                + cell.exits[Direction::East]
-                + cell.exits[Direction::West];
+    add_loops_to_dead_ends(0, same_subnet);
 
-            if (num_exits == 1)
-            {
-                auto cell_id = maze_walker.get_cell_id(cell);
-
-                maze::Cell* furthest_cell = nullptr;
-                std::size_t furthest_distance = 0;
-                Direction::Type furthest_direction = Direction::North;
-                for (std::size_t exit_index = 0; exit_index < exits.size(); ++exit_index)
-                {
-                    auto dir = static_cast<Direction::Type>(exit_index);
-                    pathfinder::NodeID adjacent_id = 0;
-                    if (!cell.exits[exit_index] && maze_walker.try_get_adjacent(cell, dir, &adjacent_id) && same_subnet(cell, dir))
-                    {
-                        auto path = maze_walker.find_path(cell_id, adjacent_id);
-                        if (!path.empty() && furthest_distance < path.size())
-                        {
-                            furthest_distance = path.size();
-                            furthest_cell = maze_walker.get_cell(adjacent_id);
-                            furthest_direction = dir;
-                        }
-                    }
-                }
-
-                if (furthest_cell)
-                {
-                    auto opposite_dir = Direction::get_opposite(furthest_direction);
-                    furthest_cell->exits[opposite_dir] = true;
-                    cell.exits[furthest_direction] = true;
-                }
-            }
-        }
-    }
+    end_pass(&PassTimings::loops);
 
     // Determine entrance and exit nodes
     maze::Cell* level_entrance = nullptr;
@@ -488,6 +625,8 @@ void networkgenerator::generate(int seed, Network* network)
         } while(!level_exit);
     } while(level_entrance == level_exit);
 
+    end_pass(&PassTimings::placement);
+
     // Render out the actual nodes
     network->subnet_count = static_cast<unsigned>(subnet_usage.size());
     auto network_size = maze_size;
@@ -525,29 +664,31 @@ void networkgenerator::generate(int seed, Network* network)
                 {
                     ++num_exits;
                     auto* tile = network->get_tile(network_pos + spec.pos_offset);
-                    tile->type = TileType::Connector;
-                    tile->connector().type = spec.connector_type;
+                    tile->set_connector(spec.connector_type);
                 }
             }
 
             if (num_exits > 0)
             {
                 auto* tile = network->get_tile(network_pos);
-                tile->type = TileType::Node;
-                tile->node().subnet_id = subnets.at(cell.x, cell.y);
+                tile->set_node(subnets.at(cell.x, cell.y));
                 available_nodes.emplace_back(network_pos, tile);
             }
         }
     }
 
+    network->build_graph();
+
+    end_pass(&PassTimings::render);
+
     network->entrance = cell_to_network_pos(*level_entrance);
     network->exit = cell_to_network_pos(*level_exit);
 
-    network->get_tile(network->entrance)->node().type = NodeType::Entrance;
-    network->get_tile(network->exit)->node().type = NodeType::Exit;
+    network->get_tile(network->entrance)->set_node_type(NodeType::Entrance);
+    network->get_tile(network->exit)->set_node_type(NodeType::Exit);
     range::erase_if(available_nodes, [](const TileData& data) { return data.tile->node().type != NodeType::Normal; });
 
-    unsigned num_placable_datastores = rng.next(data_stores_in_network.min, data_stores_in_network.max);
+    unsigned num_placable_datastores = rng.next(settings.data_stores_in_network.min, settings.data_stores_in_network.max);
     num_placable_datastores = math::min(num_placable_datastores, network->subnet_count);
     std::vector<bool> subnets_with_datastore(network->subnet_count);
     auto available_store_nodes = available_nodes;
@@ -558,7 +699,7 @@ void networkgenerator::generate(int seed, Network* network)
         if (!subnets_with_datastore[data.tile->node().subnet_id])
         {
             subnets_with_datastore[data.tile->node().subnet_id] = true;
-            data.tile->node().type = NodeType::DataStore;
+            data.tile->set_node_type(NodeType::DataStore);
             --num_placable_datastores;
         }
 
@@ -567,7 +708,7 @@ void networkgenerator::generate(int seed, Network* network)
     }
     range::erase_if(available_nodes, [](const TileData& data) { return data.tile->node().type != NodeType::Normal; });
 
-    unsigned num_placable_enemies = num_patrols;
+    unsigned num_placable_enemies = settings.num_patrols;
     network->patrolling_enemies.reserve(num_placable_enemies);
     std::vector<bool> subnets_with_enemies(network->subnet_count);
     auto available_enemy_nodes = available_nodes;
@@ -581,7 +722,7 @@ void networkgenerator::generate(int seed, Network* network)
             subnets_with_enemies[subnet] = true;
             --num_placable_enemies;
 
-            auto options = find_nodes_in_range(data.pos, patrol_length, network);
+            auto options = networktools::find_nodes_in_range(*network, data.pos, static_cast<int>(settings.patrol_length));
             if (!options.empty())
             {
                 PatrollingEnemy enemy;
@@ -594,4 +735,6 @@ void networkgenerator::generate(int seed, Network* network)
         available_enemy_nodes[tile_index] = available_enemy_nodes.back();
         available_enemy_nodes.pop_back();
     }
+
+    end_pass(&PassTimings::placement);
 }
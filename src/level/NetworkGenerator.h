@@ -1,9 +1,46 @@
 #pragma once
 
+#include <ds/Range.h>
+#include <ds/Size2.h>
+
+#include <cstddef>
+
 struct Network;
 class Random;
 
 namespace networkgenerator
 {
+    struct Settings
+    {
+        Size2i maze_size{15, 7}; // In nodes, the network is twice as large plus a border
+        int cells_per_block = 10; // Density of holes in the mesh, lower values create more holes
+        int crawler_spawn_life = 5; // Node steps a subnet grows before a new one starts
+        Rangei data_stores_in_network{3, 8};
+        unsigned num_patrols = 2;
+        unsigned patrol_length = 4;
+        std::size_t min_distance_before_creating_loop = 9; // Dead ends only get a loop that is at least this long, at most 32
+
+        static const int MinMazeSize = 3;
+
+        // Whether generate can build a network from these settings, the data store range excludes its max
+        bool is_valid() const;
+    };
+
+    // Seconds spent in each pass of generate
+    struct PassTimings
+    {
+        double blocks = 0.0;
+        double maze = 0.0;
+        double loops = 0.0;
+        double subnets = 0.0;
+        double render = 0.0;
+        double placement = 0.0;
+
+        double get_total() const { return blocks + maze + loops + subnets + render + placement; }
+        PassTimings& operator+=(const PassTimings& rhs);
+    };
+
     void generate(int seed, Network* network);
+    // Timings are added to when given
+    void generate(int seed, const Settings& settings, Network* network, PassTimings* timings = nullptr);
 };
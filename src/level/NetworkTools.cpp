@@ -1,115 +1,205 @@
 #include "NetworkTools.h"
 
-#include <Direction.h>
 #include <RangeUtil.h>
 #include <algorithm/PathFinder.h>
 #include <diag/Assert.h>
 #include <level/Network.h>
 
-#include <deque>
+#include <algorithm>
 #include <iterator>
 
 void networktools::get_node_neighbours(const Network& network, const math::Vec2i& pos, std::vector<math::Vec2i>& results)
 {
-    T3D_ASSERT(network.get_tile(pos)->type == TileType::Node);
+    const NodeIndex node = network.get_node_index(pos);
+    T3D_ASSERT(node != NodeIndexNull);
     results.clear();
-    results.reserve(4);
-    for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+    network.for_each_neighbour(node, [&network, &results](NodeIndex neighbour)
     {
-        auto delta = Direction::to_vec2i(dir);
-        auto connector_pos = pos + delta;
-        auto node_pos = connector_pos + delta;
-        if (network.get_tile(connector_pos)->type == TileType::Connector)
-        {
-            results.push_back(node_pos);
-        }
+        results.push_back(network.get_node_pos(neighbour));
+    });
+}
+
+namespace networktools
+{
+
+void Wavefront::begin(const Network& network, const math::Vec2i& start_pos, const BitPlane& mask)
+{
+    T3D_ASSERT(network.get_node_plane().get(start_pos.x, start_pos.y) && mask.get(start_pos.x, start_pos.y));
+    this->mask = &mask;
+    if (reached.width() != mask.width() || reached.height() != mask.height())
+    {
+        reached.resize(mask.width(), mask.height());
+        frontier.resize(mask.width(), mask.height());
+        next.resize(mask.width(), mask.height());
+    }
+    else
+    {
+        // Only clear what the previous search touched
+        reached.clear(reached_window);
+        frontier.clear(frontier_window);
+        next.clear(next_window);
+    }
+
+    reached.set(start_pos.x, start_pos.y);
+    frontier.set(start_pos.x, start_pos.y);
+    reached_window = frontier_window = reached.get_window(start_pos.x, start_pos.y);
+    next_window = BitPlane::Window();
+    distance = 0;
+}
+
+bool Wavefront::advance()
+{
+    // Nodes only link through connectors, so every node step covers two tiles
+    if (!advance_tiles() || !advance_tiles())
+    {
+        return false;
     }
+    ++distance;
+    return true;
+}
+
+bool Wavefront::advance_tiles()
+{
+    if (frontier_window.empty()) { return false; }
+
+    // A step moves at most one row and one word, rows still dirty from the older frontier are rewritten as well
+    const BitPlane::Window write_window = frontier_window.grown(1, 1).merged(next_window);
+    next_window = BitPlane::dilate(frontier, *mask, reached, next, write_window);
+    reached.merge(next, next_window);
+    reached_window = reached_window.merged(next_window);
+    std::swap(frontier, next);
+    std::swap(frontier_window, next_window);
+    return !frontier_window.empty();
 }
 
-void networktools::visit_nodes(const Network& network, const math::Vec2i& start_pos, NodeCallback callback)
+std::vector<math::Vec2i> find_nodes_in_range(const Network& network, const math::Vec2i& start_pos, int walk_range)
 {
-    Array2<bool> visited_nodes(network.size.width, network.size.height);
-    std::deque<VisitData> visitors;
-    visited_nodes.at(start_pos.x, start_pos.y) = true;
-    visitors.emplace_back(start_pos, 0);
-
-    std::vector<math::Vec2i> neighbours_container;
-    while(!visitors.empty())
-    {
-        auto visitor = visitors.front();
-        visitors.pop_front();
-        T3D_ASSERT(network.get_tile_safe(visitor.pos)->type == TileType::Node);
-        CallbackResult result = callback(visitor);
-        switch(result)
+    // Breadth first rather than a Wavefront: the order of the results picks patrol routes in the generator,
+    // and the wavefront setup costs more than the handful of nodes within a patrol length
+    std::vector<math::Vec2i> nodes;
+    visit_nodes(network, start_pos, [&nodes, walk_range](const VisitData& data)
+    {
+        if (data.distance_from_start == walk_range)
         {
-        default:
-            T3D_FAIL("Unhandled callback result");
-        case CallbackResult::StopVisitor:
-            break;
-        case CallbackResult::StopAllVisitors:
-            visitors.clear();
-            break;
-        case CallbackResult::Continue:
-            get_node_neighbours(network, visitor.pos, neighbours_container);
-            for (auto& node_pos : neighbours_container)
-            {
-                if (!visited_nodes.at(node_pos.x, node_pos.y))
-                {
-                    visited_nodes.at(node_pos.x, node_pos.y) = true;
-                    visitors.emplace_back(node_pos, visitor.distance_from_start + 1);
-                }
-            }
-            break;
+            nodes.push_back(data.pos);
+            return CallbackResult::StopVisitor;
         }
-    }
+        return CallbackResult::Continue;
+    });
+    return nodes;
 }
 
-struct NetworkWalker : public pathfinder::GraphWalker
+namespace detail
 {
-    using NodeID = pathfinder::NodeID;
-    using NodeList = pathfinder::NodeList;
 
-    virtual NodeList get_neighbours(NodeID id) const
+thread_local VisitContext shared_visit_context;
+
+void VisitContext::begin(std::size_t node_count)
+{
+    if (stamps.size() < node_count)
     {
-        networktools::get_node_neighbours(*network, from_id(id), neighbours);
-        NodeList result; result.reserve(neighbours.size());
-        range::transform(neighbours, std::back_inserter(result), [this](math::Vec2i pos) { return to_id(pos); });
-        return result;
+        stamps.resize(node_count, 0);
+        queue.resize(node_count);
     }
 
-    virtual float get_cost(NodeID start, NodeID end) const
+    ++generation;
+    if (generation == 0)
     {
-        return 1.0f; // Constant cost
+        // Stamps wrapped around, old entries could match again
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
     }
+    queue_head = 0;
+    queue_tail = 0;
+}
 
-    virtual float get_estimated_cost(NodeID start, NodeID end) const
+VisitContextScope::VisitContextScope(std::size_t node_count)
+{
+    if (!shared_visit_context.in_use)
     {
-        return math::distance(from_id(start), from_id(end));
+        context = &shared_visit_context;
     }
+    else
+    {
+        // Visiting from within a visitor callback, the shared context is still busy
+        nested_context.reset(new VisitContext());
+        context = nested_context.get();
+    }
+    context->in_use = true;
+    context->begin(node_count);
+}
 
-    NodeID to_id(const math::Vec2i& pos) const
+VisitContextScope::~VisitContextScope()
+{
+    context->in_use = false;
+}
+
+}
+}
+
+namespace
+{
+
+// Walks the node graph of the network, node IDs are NodeIndex values
+struct NetworkWalker
+{
+    using NodeID = pathfinder::NodeID;
+
+    std::size_t get_node_count() const
     {
-        return static_cast<NodeID>(network->tiles.get_index(pos.x, pos.y));
+        return network->get_node_count();
     }
 
-    math::Vec2i from_id(NodeID id) const
+    template<typename CallbackType>
+    void for_each_neighbour(NodeID id, CallbackType callback) const
     {
-        std::size_t x, y;
-        network->tiles.get_pos(id, &x, &y);
-        return {static_cast<int>(x), static_cast<int>(y)};
+        network->for_each_neighbour(id, [&callback](NodeIndex neighbour) { callback(neighbour, 1.0f); }); // Constant cost
     }
 
-    const Network* network = nullptr;
+    float get_estimated_cost(NodeID start, NodeID end) const
+    {
+        return network->get_estimated_steps(start, end);
+    }
 
-private:
-    mutable std::vector<math::Vec2i> neighbours; // cache
+    const Network* network = nullptr;
 };
 
+}
+
 std::vector<math::Vec2i> networktools::find_path(const Network& network, const math::Vec2i& start_pos, const math::Vec2i& end_pos)
 {
-    static NetworkWalker walker;
+    const NodeIndex start_node = network.get_node_index(start_pos);
+    const NodeIndex end_node = network.get_node_index(end_pos);
+    T3D_ASSERT(start_node != NodeIndexNull && end_node != NodeIndexNull);
+
+    const NetworkDistanceTable& table = network.distance_table;
+    if (table.is_built())
+    {
+        const unsigned distance = table.get_distance(start_node, end_node);
+        if (distance == NetworkDistanceTable::Unreachable)
+        {
+            return {};
+        }
+
+        std::vector<math::Vec2i> results;
+        results.reserve(distance + 1);
+        results.push_back(start_pos);
+        for (NodeIndex node = start_node; node != end_node;)
+        {
+            node = network.get_neighbour(node, table.get_next_hop(node, end_node));
+            results.push_back(network.get_node_pos(node));
+        }
+        return results;
+    }
+
+    if (network.subnet_paths.is_built())
+    {
+        return network.subnet_paths.find_path(network, start_pos, end_pos);
+    }
+
+    NetworkWalker walker;
     walker.network = &network;
-    pathfinder::NodeList path = pathfinder::find_path(walker, walker.to_id(start_pos), walker.to_id(end_pos));
+    pathfinder::NodeList path = pathfinder::find_path(walker, start_node, end_node);
     if (path.empty())
     {
         return {};
@@ -118,7 +208,7 @@ std::vector<math::Vec2i> networktools::find_path(const Network& network, const m
     {
         std::vector<math::Vec2i> results;
         results.reserve(path.size());
-        range::transform(path, std::back_inserter(results), [](pathfinder::NodeID id) { return walker.from_id(id); });
+        range::transform(path, std::back_inserter(results), [&network](pathfinder::NodeID id) { return network.get_node_pos(id); });
         return results;
     }
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <diag/Assert.h>
+#include <ds/BitPlane.h>
+#include <level/Network.h>
 #include <math/Vec2.h>
-#include <functional>
-#include <vector>
 
-struct Network;
+#include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace networktools
 {
@@ -25,12 +28,128 @@ namespace networktools
         int distance_from_start = 0;
     };
 
-    using NodeCallback = std::function<CallbackResult(const VisitData&)>;
-
     std::vector<math::Vec2i> get_node_neighbours(const Network& network, const math::Vec2i& pos);
     void get_node_neighbours(const Network& network, const math::Vec2i& pos, std::vector<math::Vec2i>& results);
-    void visit_nodes(const Network& network, const math::Vec2i& start_pos, NodeCallback callback);
+    // Breadth first over the nodes reachable from start_pos, callback(const VisitData&) returns a CallbackResult
+    template<typename CallbackType>
+    void visit_nodes(const Network& network, const math::Vec2i& start_pos, CallbackType callback);
     std::vector<math::Vec2i> find_path(const Network& network, const math::Vec2i& start_pos, const math::Vec2i& end_pos);
+    // Nodes exactly walk_range steps away from start_pos, in breadth first order
+    std::vector<math::Vec2i> find_nodes_in_range(const Network& network, const math::Vec2i& start_pos, int walk_range);
+
+    // Breadth first search over a tile mask, expanding 64 tiles of a row per word at a time.
+    // Only the words around the last reached nodes are touched, so small searches on huge networks stay cheap.
+    class Wavefront
+    {
+    public:
+        // Starts at the node on start_pos and only moves over tiles set in mask, which has to outlive the search
+        void begin(const Network& network, const math::Vec2i& start_pos, const BitPlane& mask);
+        // Moves one node further, returns false when no new nodes were reached
+        bool advance();
+
+        int get_distance() const { return distance; }
+        const BitPlane& get_reached() const { return reached; } // Every tile reached so far
+        // callback(const math::Vec2i&) for the nodes reached by the last step, in row order
+        template<typename CallbackType>
+        void for_each_node(CallbackType callback) const;
+
+    private:
+        bool advance_tiles();
+
+        const BitPlane* mask = nullptr;
+        BitPlane reached;
+        BitPlane frontier;
+        BitPlane next; // Still holds the frontier before the current one
+        // Parts of the planes that can hold set bits, everything outside is clear
+        BitPlane::Window reached_window;
+        BitPlane::Window frontier_window;
+        BitPlane::Window next_window;
+        int distance = 0;
+    };
+
+    namespace detail
+    {
+        // Visited nodes and queue reused between visits, nodes only count as visited when stamped by the current visit
+        struct VisitContext
+        {
+            struct Visitor
+            {
+                NodeIndex node;
+                int distance_from_start;
+            };
+
+            void begin(std::size_t node_count);
+            bool try_visit(NodeIndex node) { if (stamps[node] == generation) { return false; } stamps[node] = generation; return true; }
+            // Every node is queued at most once per visit, so the queue never has to wrap around
+            void push(const Visitor& visitor) { queue[queue_tail++] = visitor; }
+            bool empty() const { return queue_head == queue_tail; }
+            Visitor pop() { return queue[queue_head++]; }
+
+            bool in_use = false;
+            unsigned generation = 0;
+            std::vector<unsigned> stamps;
+            std::vector<Visitor> queue;
+            std::size_t queue_head = 0;
+            std::size_t queue_tail = 0;
+        };
+
+        // Claims the context of the current thread, or a new one when a visit is already running on it
+        class VisitContextScope
+        {
+        public:
+            explicit VisitContextScope(std::size_t node_count);
+            VisitContextScope(const VisitContextScope&) = delete;
+            VisitContextScope& operator=(const VisitContextScope&) = delete;
+            ~VisitContextScope();
+
+            VisitContext& get() { return *context; }
+
+        private:
+            VisitContext* context = nullptr;
+            std::unique_ptr<VisitContext> nested_context;
+        };
+    }
+}
+
+template<typename CallbackType>
+void networktools::Wavefront::for_each_node(CallbackType callback) const
+{
+    frontier.for_each_set(frontier_window, [&callback](int x, int y) { callback(math::Vec2i{x, y}); });
+}
+
+template<typename CallbackType>
+void networktools::visit_nodes(const Network& network, const math::Vec2i& start_pos, CallbackType callback)
+{
+    const NodeIndex start_node = network.get_node_index(start_pos);
+    T3D_ASSERT(start_node != NodeIndexNull);
+    detail::VisitContextScope scope(network.get_node_count());
+    detail::VisitContext& context = scope.get();
+    context.try_visit(start_node);
+    context.push({start_node, 0});
+
+    while (!context.empty())
+    {
+        const detail::VisitContext::Visitor visitor = context.pop();
+        CallbackResult result = callback(VisitData(network.get_node_pos(visitor.node), visitor.distance_from_start));
+        switch(result)
+        {
+        default:
+            T3D_FAIL("Unhandled callback result");
+        case CallbackResult::StopVisitor:
+            break;
+        case CallbackResult::StopAllVisitors:
+            return;
+        case CallbackResult::Continue:
+            network.for_each_neighbour(visitor.node, [&context, &visitor](NodeIndex neighbour)
+            {
+                if (context.try_visit(neighbour))
+                {
+                    context.push({neighbour, visitor.distance_from_start + 1});
+                }
+            });
+            break;
+        }
+    }
 }
 
 inline std::vector<math::Vec2i> networktools::get_node_neighbours(const Network& network, const math::Vec2i& pos)
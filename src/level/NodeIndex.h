@@ -0,0 +1,4 @@
+#pragma once
+
+using NodeIndex = unsigned; // Dense index over the node tiles of a Network
+static const NodeIndex NodeIndexNull = 0xFFFFFFFF;
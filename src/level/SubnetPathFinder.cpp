@@ -0,0 +1,282 @@
+#include "SubnetPathFinder.h"
+
+#include <algorithm/PathFinder.h>
+#include <diag/Assert.h>
+#include <level/Network.h>
+
+#include <algorithm>
+
+namespace
+{
+
+const unsigned NoPortal = static_cast<unsigned>(-1);
+const unsigned Unreached = static_cast<unsigned>(-1);
+
+// Breadth first search that never leaves the subnet of its start node.
+// Only the visited entries are reset afterwards, so searches stay proportional to the subnet size.
+struct SubnetSearch
+{
+    std::vector<unsigned> distances;
+    std::vector<NodeIndex> parents; // Towards the start node
+    std::vector<NodeIndex> visited;
+
+    void run(const Network& network, const std::vector<unsigned>& node_subnets, NodeIndex start)
+    {
+        if (distances.size() < network.get_node_count())
+        {
+            distances.resize(network.get_node_count(), Unreached);
+            parents.resize(network.get_node_count());
+        }
+        reset();
+
+        const unsigned subnet = node_subnets[start];
+        distances[start] = 0;
+        parents[start] = start;
+        visited.push_back(start);
+        for (std::size_t visit_index = 0; visit_index < visited.size(); ++visit_index)
+        {
+            const NodeIndex current = visited[visit_index];
+            network.for_each_neighbour(current, [this, &node_subnets, subnet, current](NodeIndex neighbour)
+            {
+                if (node_subnets[neighbour] == subnet && distances[neighbour] == Unreached)
+                {
+                    distances[neighbour] = distances[current] + 1;
+                    parents[neighbour] = current;
+                    visited.push_back(neighbour);
+                }
+            });
+        }
+    }
+
+    void reset()
+    {
+        for (NodeIndex node : visited)
+        {
+            distances[node] = Unreached;
+        }
+        visited.clear();
+    }
+};
+
+struct QueryContext
+{
+    SubnetSearch start_search;
+    SubnetSearch end_search;
+};
+
+thread_local QueryContext query_context;
+
+}
+
+// Portal graph extended with the start and end node of a single query
+struct SubnetPathFinder::PortalWalker
+{
+    using NodeID = pathfinder::NodeID;
+
+    const SubnetPathFinder* finder;
+    const Network* network;
+    const SubnetSearch* start_search;
+    const SubnetSearch* end_search;
+    NodeIndex start_node;
+    NodeIndex end_node;
+
+    NodeID get_start_id() const { return static_cast<NodeID>(finder->portal_nodes.size()); }
+    NodeID get_end_id() const { return get_start_id() + 1; }
+    std::size_t get_node_count() const { return finder->portal_nodes.size() + 2; }
+
+    template<typename CallbackType>
+    void for_each_neighbour(NodeID id, CallbackType callback) const
+    {
+        if (id == get_end_id()) { return; }
+
+        if (id == get_start_id())
+        {
+            for_each_subnet_portal(network->subnet_topology.get_node_subnet(start_node), [this, &callback](unsigned portal)
+            {
+                const unsigned distance = start_search->distances[finder->portal_nodes[portal]];
+                if (distance != Unreached) { callback(portal, static_cast<float>(distance)); }
+            });
+            const unsigned distance = start_search->distances[end_node];
+            if (distance != Unreached) { callback(get_end_id(), static_cast<float>(distance)); }
+            return;
+        }
+
+        for (unsigned edge = finder->edge_offsets[id]; edge < finder->edge_offsets[id + 1]; ++edge)
+        {
+            callback(finder->edges[edge].target, static_cast<float>(finder->edges[edge].cost));
+        }
+        const unsigned distance = end_search->distances[finder->portal_nodes[id]];
+        if (distance != Unreached) { callback(get_end_id(), static_cast<float>(distance)); }
+    }
+
+    float get_estimated_cost(NodeID start, NodeID end) const
+    {
+        return network->get_estimated_steps(get_node(start), get_node(end));
+    }
+
+    NodeIndex get_node(NodeID id) const
+    {
+        if (id == get_start_id()) { return start_node; }
+        if (id == get_end_id()) { return end_node; }
+        return finder->portal_nodes[id];
+    }
+
+    unsigned find_edge(NodeID start, NodeID end) const
+    {
+        for (unsigned edge = finder->edge_offsets[start]; edge < finder->edge_offsets[start + 1]; ++edge)
+        {
+            if (finder->edges[edge].target == end) { return edge; }
+        }
+        T3D_FAIL("Portals are not linked");
+        return finder->edge_offsets[start];
+    }
+
+    template<typename CallbackType>
+    void for_each_subnet_portal(unsigned subnet, CallbackType callback) const
+    {
+        for (unsigned index = finder->subnet_portal_offsets[subnet]; index < finder->subnet_portal_offsets[subnet + 1]; ++index)
+        {
+            callback(finder->subnet_portals[index]);
+        }
+    }
+};
+
+void SubnetPathFinder::build(const Network& network)
+{
+    clear();
+    const std::size_t node_count = network.get_node_count();
+    if (node_count == 0) { return; }
+
+    const std::vector<unsigned>& node_subnets = network.subnet_topology.get_node_subnets();
+
+    // Any node linked to another subnet is a portal
+    node_portals.assign(node_count, NoPortal);
+    for (NodeIndex node = 0; node < node_count; ++node)
+    {
+        network.for_each_neighbour(node, [this, &node_subnets, node](NodeIndex neighbour)
+        {
+            if (node_subnets[neighbour] != node_subnets[node] && node_portals[node] == NoPortal)
+            {
+                node_portals[node] = static_cast<unsigned>(portal_nodes.size());
+                portal_nodes.push_back(node);
+            }
+        });
+    }
+
+    subnet_portal_offsets.assign(network.subnet_count + 1, 0);
+    for (unsigned node : portal_nodes)
+    {
+        T3D_ASSERT(node_subnets[node] < network.subnet_count);
+        ++subnet_portal_offsets[node_subnets[node] + 1];
+    }
+    for (unsigned subnet = 0; subnet < network.subnet_count; ++subnet)
+    {
+        subnet_portal_offsets[subnet + 1] += subnet_portal_offsets[subnet];
+    }
+    subnet_portals.resize(portal_nodes.size());
+    {
+        std::vector<unsigned> fill_offsets(subnet_portal_offsets.begin(), subnet_portal_offsets.end() - 1);
+        for (unsigned portal = 0; portal < portal_nodes.size(); ++portal)
+        {
+            subnet_portals[fill_offsets[node_subnets[portal_nodes[portal]]]++] = portal;
+        }
+    }
+
+    // Link portals across separators and to every portal they can reach within their subnet
+    SubnetSearch search;
+    edge_offsets.reserve(portal_nodes.size() + 1);
+    for (unsigned portal = 0; portal < portal_nodes.size(); ++portal)
+    {
+        edge_offsets.push_back(static_cast<unsigned>(edges.size()));
+        const NodeIndex portal_node = portal_nodes[portal];
+        network.for_each_neighbour(portal_node, [this, &node_subnets, portal_node](NodeIndex neighbour)
+        {
+            if (node_subnets[neighbour] != node_subnets[portal_node])
+            {
+                edges.push_back({node_portals[neighbour], 1, static_cast<unsigned>(edge_paths.size())});
+                edge_paths.push_back(neighbour);
+            }
+        });
+
+        search.run(network, node_subnets, portal_node);
+        const unsigned subnet = node_subnets[portal_node];
+        for (unsigned index = subnet_portal_offsets[subnet]; index < subnet_portal_offsets[subnet + 1]; ++index)
+        {
+            const unsigned target = subnet_portals[index];
+            const NodeIndex target_node = portal_nodes[target];
+            if (target == portal || search.distances[target_node] == Unreached) { continue; }
+
+            const std::size_t path_offset = edge_paths.size();
+            edges.push_back({target, search.distances[target_node], static_cast<unsigned>(path_offset)});
+            for (NodeIndex node = target_node; node != portal_node; node = search.parents[node])
+            {
+                edge_paths.push_back(node);
+            }
+            std::reverse(edge_paths.begin() + path_offset, edge_paths.end());
+        }
+    }
+    edge_offsets.push_back(static_cast<unsigned>(edges.size()));
+}
+
+void SubnetPathFinder::clear()
+{
+    node_portals.clear();
+    portal_nodes.clear();
+    subnet_portal_offsets.clear();
+    subnet_portals.clear();
+    edge_offsets.clear();
+    edges.clear();
+    edge_paths.clear();
+}
+
+std::vector<math::Vec2i> SubnetPathFinder::find_path(const Network& network, const math::Vec2i& start_pos, const math::Vec2i& end_pos) const
+{
+    T3D_ASSERT(node_portals.size() == network.get_node_count());
+    const std::vector<unsigned>& node_subnets = network.subnet_topology.get_node_subnets();
+    QueryContext& context = query_context;
+    PortalWalker walker{this, &network, &context.start_search, &context.end_search, network.get_node_index(start_pos), network.get_node_index(end_pos)};
+    T3D_ASSERT(walker.start_node != NodeIndexNull && walker.end_node != NodeIndexNull);
+    context.start_search.run(network, node_subnets, walker.start_node);
+    context.end_search.run(network, node_subnets, walker.end_node);
+
+    const pathfinder::NodeList route = pathfinder::find_path(walker, walker.get_start_id(), walker.get_end_id());
+    if (route.empty())
+    {
+        return {};
+    }
+
+    std::vector<math::Vec2i> path;
+    path.push_back(start_pos);
+    for (std::size_t route_index = 1; route_index < route.size(); ++route_index)
+    {
+        const pathfinder::NodeID from = route[route_index - 1];
+        const pathfinder::NodeID to = route[route_index];
+        if (from == walker.get_start_id())
+        {
+            // Parents lead back to the start, so walk backwards and flip the nodes afterwards
+            const std::size_t segment_offset = path.size();
+            for (NodeIndex node = walker.get_node(to); node != walker.start_node; node = context.start_search.parents[node])
+            {
+                path.push_back(network.get_node_pos(node));
+            }
+            std::reverse(path.begin() + segment_offset, path.end());
+        }
+        else if (to == walker.get_end_id())
+        {
+            for (NodeIndex node = walker.get_node(from); node != walker.end_node;)
+            {
+                node = context.end_search.parents[node];
+                path.push_back(network.get_node_pos(node));
+            }
+        }
+        else
+        {
+            const Edge& edge = edges[walker.find_edge(from, to)];
+            for (unsigned index = 0; index < edge.cost; ++index)
+            {
+                path.push_back(network.get_node_pos(edge_paths[edge.path_offset + index]));
+            }
+        }
+    }
+    return path;
+}
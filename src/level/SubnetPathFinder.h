@@ -0,0 +1,45 @@
+#pragma once
+
+#include "NodeIndex.h"
+
+#include <math/Vec2.h>
+
+#include <cstddef>
+#include <vector>
+
+struct Network;
+
+// Two level path finder over the subnets of a network.
+// Portals are the nodes next to a connector separating two subnets. Routes are planned over the portal graph, which
+// links portals across separators and to the other portals of their subnet. Paths between portals of a subnet are
+// found once on build, so a query only searches within the subnets of its start and end node.
+class SubnetPathFinder
+{
+public:
+    void build(const Network& network);
+    void clear();
+
+    bool is_built() const { return !node_portals.empty(); }
+    std::size_t get_portal_count() const { return portal_nodes.size(); }
+    // Shortest path including both ends, empty when end cannot be reached
+    std::vector<math::Vec2i> find_path(const Network& network, const math::Vec2i& start_pos, const math::Vec2i& end_pos) const;
+
+private:
+    struct Edge
+    {
+        unsigned target; // Portal index
+        unsigned cost;
+        unsigned path_offset; // Nodes walked to reach target, ending with the target node
+    };
+
+    struct PortalWalker;
+
+    // Subnets of nodes come from Network::subnet_topology
+    std::vector<unsigned> node_portals; // Per NodeIndex, portal index or NoPortal
+    std::vector<NodeIndex> portal_nodes;
+    std::vector<unsigned> subnet_portal_offsets; // Portals sorted by subnet, subnet count + 1 entries
+    std::vector<unsigned> subnet_portals;
+    std::vector<unsigned> edge_offsets; // Portal count + 1 entries
+    std::vector<Edge> edges;
+    std::vector<NodeIndex> edge_paths;
+};
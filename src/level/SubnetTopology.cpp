@@ -0,0 +1,114 @@
+#include "SubnetTopology.h"
+
+#include "Network.h"
+
+#include <Direction.h>
+#include <diag/Assert.h>
+
+#include <algorithm>
+
+namespace
+{
+
+struct Crossing
+{
+    unsigned from;
+    unsigned to;
+    math::Vec2i pos;
+};
+
+inline bool operator<(const Crossing& lhs, const Crossing& rhs)
+{
+    if (lhs.from != rhs.from) { return lhs.from < rhs.from; }
+    if (lhs.to != rhs.to) { return lhs.to < rhs.to; }
+    if (lhs.pos.y != rhs.pos.y) { return lhs.pos.y < rhs.pos.y; }
+    return lhs.pos.x < rhs.pos.x;
+}
+
+}
+
+void SubnetTopology::build(const Network& network)
+{
+    clear();
+    const std::size_t node_count = network.get_node_count();
+    const std::size_t subnet_count = network.subnet_count;
+
+    node_subnets.resize(node_count);
+    subnet_node_offsets.assign(subnet_count + 1, 0);
+    for (NodeIndex node = 0; node < node_count; ++node)
+    {
+        const SubnetID subnet = network.get_tile(network.get_node_pos(node))->node().subnet_id;
+        T3D_ASSERT(subnet < subnet_count);
+        node_subnets[node] = subnet;
+        ++subnet_node_offsets[subnet + 1];
+    }
+    for (std::size_t subnet = 0; subnet < subnet_count; ++subnet)
+    {
+        subnet_node_offsets[subnet + 1] += subnet_node_offsets[subnet];
+    }
+
+    // Placing nodes in index order keeps every subnet in row order
+    subnet_nodes.resize(node_count);
+    bounds.resize(subnet_count);
+    std::vector<unsigned> fill_offsets(subnet_node_offsets.begin(), subnet_node_offsets.end() - 1);
+    std::vector<Crossing> crossings;
+    for (NodeIndex node = 0; node < node_count; ++node)
+    {
+        const unsigned subnet = node_subnets[node];
+        const math::Vec2i& pos = network.get_node_pos(node);
+        Recti& rect = bounds[subnet];
+        if (fill_offsets[subnet] == subnet_node_offsets[subnet])
+        {
+            rect.set(pos.x, pos.y, 1, 1);
+        }
+        else
+        {
+            rect.left = std::min(rect.left, pos.x);
+            rect.right = std::max(rect.right, pos.x + 1);
+            rect.bottom = pos.y + 1; // Rows never go back up
+        }
+        subnet_nodes[fill_offsets[subnet]++] = node;
+
+        // Separators are found from both ends, once for each direction of the link
+        for (int dir = Direction::First; dir <= Direction::Last; ++dir)
+        {
+            if (!(network.get_node_exits(node) & (1u << dir))) { continue; }
+
+            const unsigned neighbour_subnet = node_subnets[network.get_neighbour(node, static_cast<Direction::Type>(dir))];
+            if (neighbour_subnet != subnet)
+            {
+                crossings.push_back({subnet, neighbour_subnet, pos + Direction::to_vec2i(dir)});
+            }
+        }
+    }
+
+    std::sort(crossings.begin(), crossings.end());
+    subnet_link_offsets.assign(subnet_count + 1, 0);
+    separators.reserve(crossings.size());
+    for (std::size_t index = 0; index < crossings.size(); ++index)
+    {
+        const Crossing& crossing = crossings[index];
+        if (index == 0 || crossing.from != crossings[index - 1].from || crossing.to != crossings[index - 1].to)
+        {
+            links.push_back({crossing.to, static_cast<unsigned>(separators.size()), 0});
+            ++subnet_link_offsets[crossing.from + 1];
+        }
+        ++links.back().separator_count;
+        separators.push_back(crossing.pos);
+    }
+    for (std::size_t subnet = 0; subnet < subnet_count; ++subnet)
+    {
+        subnet_link_offsets[subnet + 1] += subnet_link_offsets[subnet];
+    }
+}
+
+void SubnetTopology::clear()
+{
+    node_subnets.clear();
+    subnet_node_offsets.clear();
+    subnet_nodes.clear();
+    bounds.clear();
+    subnet_link_offsets.clear();
+    links.clear();
+    separators.clear();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "NodeIndex.h"
+
+#include <ds/ArrayView.h>
+#include <ds/Rect.h>
+#include <math/Vec2.h>
+
+#include <cstddef>
+#include <vector>
+
+struct Network;
+
+// Subnet layout of a network: which nodes make up each subnet and which subnets border each other.
+// Network rebuilds it along with its graph, every query is a lookup.
+class SubnetTopology
+{
+public:
+    // Neighbouring subnet, reached through one or more separator connectors
+    struct Link
+    {
+        unsigned subnet;
+        unsigned first_separator; // Into the separators of the subnet the link belongs to
+        unsigned separator_count;
+    };
+
+    void build(const Network& network);
+    void clear();
+
+    std::size_t get_subnet_count() const { return bounds.size(); }
+    unsigned get_node_subnet(NodeIndex node) const { return node_subnets[node]; }
+    const std::vector<unsigned>& get_node_subnets() const { return node_subnets; }
+    // Nodes of a subnet in row order
+    ArrayView<const NodeIndex> get_nodes(std::size_t subnet) const { return get_range(subnet_node_offsets, subnet_nodes, subnet); }
+    // Smallest rect holding every node of a subnet
+    const Recti& get_bounds(std::size_t subnet) const { return bounds[subnet]; }
+    // Bordering subnets in ascending order
+    ArrayView<const Link> get_links(std::size_t subnet) const { return get_range(subnet_link_offsets, links, subnet); }
+    // Positions of the connectors a link crosses, in row order
+    ArrayView<const math::Vec2i> get_separators(const Link& link) const { return {separators.data() + link.first_separator, link.separator_count}; }
+
+private:
+    template<typename T>
+    static ArrayView<const T> get_range(const std::vector<unsigned>& offsets, const std::vector<T>& items, std::size_t index)
+    {
+        return {items.data() + offsets[index], offsets[index + 1] - offsets[index]};
+    }
+
+    std::vector<unsigned> node_subnets; // Per NodeIndex
+    std::vector<unsigned> subnet_node_offsets; // Subnet count + 1 entries
+    std::vector<NodeIndex> subnet_nodes;
+    std::vector<Recti> bounds; // Per subnet
+    std::vector<unsigned> subnet_link_offsets; // Subnet count + 1 entries
+    std::vector<Link> links;
+    std::vector<math::Vec2i> separators;
+};
@@ -0,0 +1,265 @@
+#include <ecs/ComponentPool.h>
+#include <ecs/ECS.h>
+#include <ecs/EntityID.h>
+#include <Random.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Times the sparse set ecs::ComponentPool against the unordered_map pool it replaced,
+// with random lookups followed by removing and re-adding every second entity.
+// Also times ecs::ECS::is_alive against the set of pending destroys it replaced.
+
+namespace
+{
+
+struct Position
+{
+    int x = 0;
+    int y = 0;
+};
+
+// Lookup structure of the replaced pool: entity handles hashed to the index of the component in a dense array
+template<typename ComponentType>
+class MapComponentPool
+{
+public:
+    ComponentType* get(const ecs::EntityID& entity)
+    {
+        auto redirect = handles.find(entity);
+        return redirect != end(handles) ? &components[redirect->second] : nullptr;
+    }
+
+    ComponentType* add(const ecs::EntityID& entity)
+    {
+        handles.emplace(entity, components.size());
+        owners.push_back(entity);
+        components.emplace_back();
+        return &components.back();
+    }
+
+    void remove(const ecs::EntityID& entity)
+    {
+        auto redirect = handles.find(entity);
+        const std::size_t data_index = redirect->second;
+        if (data_index + 1 != components.size())
+        {
+            components[data_index] = components.back();
+            owners[data_index] = owners.back();
+            handles.find(owners[data_index])->second = data_index;
+        }
+        components.pop_back();
+        owners.pop_back();
+        handles.erase(redirect);
+    }
+
+private:
+    std::unordered_map<ecs::EntityID, std::size_t> handles;
+    std::vector<ecs::EntityID> owners;
+    std::vector<ComponentType> components;
+};
+
+struct SparseComponentPool : ecs::ComponentPool<Position>
+{
+    Position* get(const ecs::EntityID& entity) { return static_cast<Position*>(ecs::ComponentPool<Position>::get(entity)); }
+    Position* add(const ecs::EntityID& entity) { return ecs::ComponentPool<Position>::add(entity); }
+};
+
+// Liveness check of the replaced ECS: entities pending destruction were kept in a set searched on every check.
+// The original set compared handles through operator bool, this one orders them by value.
+class SetLiveness
+{
+public:
+    explicit SetLiveness(std::size_t entity_count)
+    {
+        for (std::size_t entity_index = 0; entity_index < entity_count; ++entity_index)
+        {
+            entities.emplace_back(entity_index, 0u);
+        }
+    }
+
+    const ecs::EntityID& get_entity(std::size_t entity_index) const { return entities[entity_index]; }
+    void destroy_entity(const ecs::EntityID& entity) { destroyed_entities.insert(entity); }
+    bool is_alive(const ecs::EntityID& entity) const
+    {
+        return entity.index() < entities.size() && entities[entity.index()] == entity && destroyed_entities.find(entity) == end(destroyed_entities);
+    }
+
+private:
+    struct EntityLess
+    {
+        bool operator()(const ecs::EntityID& lhs, const ecs::EntityID& rhs) const { return lhs.value() < rhs.value(); }
+    };
+
+    std::vector<ecs::EntityID> entities;
+    std::set<ecs::EntityID, EntityLess> destroyed_entities;
+};
+
+class SlotLiveness
+{
+public:
+    explicit SlotLiveness(std::size_t entity_count)
+    {
+        for (std::size_t entity_index = 0; entity_index < entity_count; ++entity_index)
+        {
+            entities.push_back(ecs.create_entity().entity_id());
+        }
+    }
+
+    const ecs::EntityID& get_entity(std::size_t entity_index) const { return entities[entity_index]; }
+    void destroy_entity(const ecs::EntityID& entity) { ecs.destroy_entity(entity); }
+    bool is_alive(const ecs::EntityID& entity) const { return ecs.is_alive(entity); }
+
+private:
+    ecs::ECS ecs;
+    std::vector<ecs::EntityID> entities;
+};
+
+double get_seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Timings
+{
+    double get_ns = 0.0;
+    double churn_ns = 0.0;
+};
+
+template<typename PoolType>
+Timings run(std::size_t entity_count, long long* checksum)
+{
+    static const int get_repeats = 5;
+
+    PoolType pool;
+    std::vector<ecs::EntityID> entities;
+    entities.reserve(entity_count);
+    for (std::size_t entity_index = 0; entity_index < entity_count; ++entity_index)
+    {
+        entities.emplace_back(entity_index, 0u);
+        pool.add(entities.back())->x = static_cast<int>(entity_index);
+    }
+
+    Random rng(1);
+    std::vector<ecs::EntityID> lookups;
+    lookups.reserve(entity_count);
+    for (std::size_t lookup_index = 0; lookup_index < entity_count; ++lookup_index)
+    {
+        lookups.push_back(entities[rng.next(static_cast<int>(entity_count))]);
+    }
+
+    const double start = get_seconds();
+    for (int repeat = 0; repeat < get_repeats; ++repeat)
+    {
+        for (const auto& entity : lookups)
+        {
+            *checksum += pool.get(entity)->x;
+        }
+    }
+    const double middle = get_seconds();
+    for (std::size_t entity_index = 0; entity_index < entity_count; entity_index += 2)
+    {
+        pool.remove(entities[entity_index]);
+    }
+    for (std::size_t entity_index = 0; entity_index < entity_count; entity_index += 2)
+    {
+        pool.add(entities[entity_index])->x = static_cast<int>(entity_index);
+    }
+    const double end = get_seconds();
+
+    Timings timings;
+    timings.get_ns = (middle - start) * 1000000000.0 / (get_repeats * entity_count);
+    timings.churn_ns = (end - middle) * 1000000000.0 / entity_count; // One remove or add per entity
+    return timings;
+}
+
+// Checks every entity in index order, returns ns per check
+template<typename LivenessType>
+double run_liveness(const LivenessType& liveness, std::size_t entity_count, long long* checksum)
+{
+    static const int check_repeats = 5;
+
+    const double start = get_seconds();
+    for (int repeat = 0; repeat < check_repeats; ++repeat)
+    {
+        for (std::size_t entity_index = 0; entity_index < entity_count; ++entity_index)
+        {
+            *checksum += liveness.is_alive(liveness.get_entity(entity_index)) ? 1 : 0;
+        }
+    }
+    return (get_seconds() - start) * 1000000000.0 / (check_repeats * entity_count);
+}
+
+void run_liveness(std::size_t entity_count, int repeats, long long* checksum)
+{
+    static const int pending_destroy_count = 64;
+
+    SetLiveness set_liveness(entity_count);
+    SlotLiveness slot_liveness(entity_count);
+    double best[4] = {};
+    for (int pending = 0; pending < 2; ++pending)
+    {
+        if (pending)
+        {
+            Random rng(2);
+            for (int destroy_index = 0; destroy_index < pending_destroy_count; ++destroy_index)
+            {
+                const std::size_t entity_index = static_cast<std::size_t>(rng.next(static_cast<int>(entity_count)));
+                set_liveness.destroy_entity(set_liveness.get_entity(entity_index));
+                slot_liveness.destroy_entity(slot_liveness.get_entity(entity_index));
+            }
+        }
+
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            const double set_ns = run_liveness(set_liveness, entity_count, checksum);
+            const double slot_ns = run_liveness(slot_liveness, entity_count, checksum);
+            best[pending * 2] = repeat == 0 ? set_ns : std::min(best[pending * 2], set_ns);
+            best[pending * 2 + 1] = repeat == 0 ? slot_ns : std::min(best[pending * 2 + 1], slot_ns);
+        }
+    }
+    std::printf("  %8zu %12.1f %12.1f %12.1f %12.1f\n", entity_count, best[0], best[1], best[2], best[3]);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    static const std::size_t entity_counts[] = {10000, 100000, 1000000};
+    const int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+
+    long long checksum = 0;
+    std::printf("Component pool, ns per operation, best of %d\n  %8s %12s %12s %12s %12s\n", repeats,
+        "entities", "map get", "sparse get", "map churn", "sparse churn");
+    for (std::size_t entity_count : entity_counts)
+    {
+        Timings map_best;
+        Timings sparse_best;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            const Timings map_timings = run<MapComponentPool<Position>>(entity_count, &checksum);
+            const Timings sparse_timings = run<SparseComponentPool>(entity_count, &checksum);
+            map_best.get_ns = repeat == 0 ? map_timings.get_ns : std::min(map_best.get_ns, map_timings.get_ns);
+            map_best.churn_ns = repeat == 0 ? map_timings.churn_ns : std::min(map_best.churn_ns, map_timings.churn_ns);
+            sparse_best.get_ns = repeat == 0 ? sparse_timings.get_ns : std::min(sparse_best.get_ns, sparse_timings.get_ns);
+            sparse_best.churn_ns = repeat == 0 ? sparse_timings.churn_ns : std::min(sparse_best.churn_ns, sparse_timings.churn_ns);
+        }
+        std::printf("  %8zu %12.1f %12.1f %12.1f %12.1f\n", entity_count, map_best.get_ns, sparse_best.get_ns, map_best.churn_ns, sparse_best.churn_ns);
+    }
+
+    std::printf("\nEntity liveness, ns per is_alive, best of %d\n  %8s %12s %12s %12s %12s\n", repeats,
+        "entities", "set", "slot", "set 64 dead", "slot 64 dead");
+    for (std::size_t entity_count : entity_counts)
+    {
+        run_liveness(entity_count, repeats, &checksum);
+    }
+
+    // Printed so the lookups cannot be optimized away
+    std::printf("checksum %lld\n", checksum);
+    return EXIT_SUCCESS;
+}
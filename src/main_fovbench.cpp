@@ -0,0 +1,181 @@
+#include <fov/Fov.h>
+#include <level/Network.h>
+#include <level/NetworkGenerator.h>
+#include <Random.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Times fov::MyVisibility against the templated fov::Visibility over the same maps, origins and radii,
+// and checks both see exactly the same tiles
+
+namespace
+{
+
+struct Map
+{
+    int width = 0;
+    int height = 0;
+    std::vector<bool> walls;
+
+    bool blocks_light(int x, int y) const { return x < 0 || y < 0 || x >= width || y >= height || walls[y * width + x]; }
+};
+
+// Tile stamps so every compute starts from an empty set without clearing the map
+struct SeenTiles
+{
+    explicit SeenTiles(const Map& map) : map(&map), stamps(map.walls.size(), 0) {}
+
+    void begin() { ++stamp; count = 0; }
+    void set_visible(int x, int y)
+    {
+        if (x < 0 || y < 0 || x >= map->width || y >= map->height) { return; }
+
+        unsigned& tile_stamp = stamps[y * map->width + x];
+        count += tile_stamp != stamp ? 1 : 0;
+        tile_stamp = stamp;
+    }
+    bool is_visible(std::size_t index) const { return stamps[index] == stamp; }
+
+    const Map* map;
+    std::vector<unsigned> stamps;
+    unsigned stamp = 0;
+    std::size_t count = 0;
+};
+
+double get_seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Map create_network_map(int seed, std::vector<math::Vec2i>* origins)
+{
+    networkgenerator::Settings settings;
+    settings.maze_size = Size2i(100, 100);
+    Network network;
+    networkgenerator::generate(seed, settings, &network);
+
+    Map map;
+    map.width = network.size.width;
+    map.height = network.size.height;
+    map.walls.resize(static_cast<std::size_t>(map.width * map.height));
+    const BitPlane& walkable = network.get_walkable_plane();
+    for (int y = 0; y < map.height; ++y)
+    {
+        for (int x = 0; x < map.width; ++x)
+        {
+            map.walls[y * map.width + x] = !walkable.get(x, y);
+        }
+    }
+
+    for (NodeIndex node = 0; node < network.get_node_count(); node += 7)
+    {
+        origins->push_back(network.get_node_pos(node));
+    }
+    return map;
+}
+
+// Mostly open map, where large radii see thousands of tiles
+Map create_open_map(int seed, std::vector<math::Vec2i>* origins)
+{
+    static const int size = 256;
+    Random rng(seed);
+    Map map;
+    map.width = size;
+    map.height = size;
+    map.walls.resize(size * size);
+    for (std::size_t index = 0; index < map.walls.size(); ++index)
+    {
+        map.walls[index] = rng.next(100) < 8;
+    }
+
+    for (int origin_index = 0; origin_index < 400; ++origin_index)
+    {
+        const math::Vec2i origin{size / 4 + (rng.next(size / 2) & (size / 2 - 1)), size / 4 + (rng.next(size / 2) & (size / 2 - 1))};
+        map.walls[origin.y * size + origin.x] = false;
+        origins->push_back(origin);
+    }
+    return map;
+}
+
+bool run(const char* name, const Map& map, const std::vector<math::Vec2i>& origins)
+{
+    static const int radii[] = {4, 8, 16, 32, 64};
+    static const int repeats = 3;
+
+    std::printf("%s, %zu origins\n  %6s %12s %12s %8s %10s\n", name, origins.size(), "radius", "function us", "template us", "speedup", "tiles");
+    bool all_match = true;
+    SeenTiles function_tiles(map);
+    SeenTiles template_tiles(map);
+    for (int radius : radii)
+    {
+        const int radius_squared = radius * (radius + 1);
+        auto get_distance = [radius, radius_squared](int x, int y) { return x * x + y * y <= radius_squared ? radius : radius + 1; };
+        auto blocks_light = [&map](int x, int y) { return map.blocks_light(x, y); };
+        auto set_template_visible = [&template_tiles](int x, int y) { template_tiles.set_visible(x, y); };
+        fov::MyVisibility function_visibility(blocks_light, [&function_tiles](int x, int y) { function_tiles.set_visible(x, y); }, get_distance);
+        auto template_visibility = fov::make_visibility(blocks_light, set_template_visible, get_distance);
+
+        double function_seconds = 0.0;
+        double template_seconds = 0.0;
+        std::size_t tile_count = 0;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            const double start = get_seconds();
+            for (const auto& origin : origins)
+            {
+                function_tiles.begin();
+                function_visibility.Compute(origin, fov::OctantSet().set(), radius);
+            }
+            const double middle = get_seconds();
+            for (const auto& origin : origins)
+            {
+                template_tiles.begin();
+                template_visibility.compute(origin, fov::OctantSet().set(), radius);
+            }
+            const double end = get_seconds();
+            function_seconds = repeat == 0 ? middle - start : std::min(function_seconds, middle - start);
+            template_seconds = repeat == 0 ? end - middle : std::min(template_seconds, end - middle);
+        }
+
+        bool match = true;
+        for (const auto& origin : origins)
+        {
+            function_tiles.begin();
+            template_tiles.begin();
+            function_visibility.Compute(origin, fov::OctantSet().set(), radius);
+            template_visibility.compute(origin, fov::OctantSet().set(), radius);
+            tile_count += template_tiles.count;
+            for (std::size_t index = 0; index < map.walls.size() && match; ++index)
+            {
+                match = function_tiles.is_visible(index) == template_tiles.is_visible(index);
+            }
+        }
+        all_match = all_match && match;
+
+        const double scale = 1000000.0 / origins.size();
+        std::printf("  %6d %12.2f %12.2f %7.2fx %10.1f%s\n", radius, function_seconds * scale, template_seconds * scale,
+            function_seconds / std::max(template_seconds, 0.000000001), static_cast<double>(tile_count) / origins.size(), match ? "" : "  MISMATCH");
+    }
+    return all_match;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int seed = argc > 1 ? std::atoi(argv[1]) : 7;
+
+    std::vector<math::Vec2i> network_origins;
+    const Map network_map = create_network_map(seed, &network_origins);
+    std::vector<math::Vec2i> open_origins;
+    const Map open_map = create_open_map(seed, &open_origins);
+
+    bool match = run("Network 201x201", network_map, network_origins);
+    std::printf("\n");
+    match = run("Open 256x256, 8% walls", open_map, open_origins) && match;
+    return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
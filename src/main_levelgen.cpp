@@ -0,0 +1,175 @@
+#include <level/LevelBatch.h>
+#include <os/WorkerPool.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Generates a batch of levels without running the game, to measure the generator and to pick seeds by layout
+
+namespace
+{
+
+void print_usage()
+{
+    std::printf(
+        "usage: tinyhack_levelgen [options]\n"
+        "  --first <seed>                First seed to generate (0)\n"
+        "  --count <n>                   Number of seeds (1000)\n"
+        "  --size <width>x<height>       Maze size in nodes (15x7)\n"
+        "  --threads <n>                 Threads generating levels, this one included (one per core)\n"
+        "  --list                        Print the stats of every matching seed\n"
+        "Constraints, as <value> or <min>-<max>:\n"
+        "  --subnets                     Number of subnets\n"
+        "  --data-stores                 Number of data stores\n"
+        "  --patrols                     Number of patrolling enemies\n"
+        "  --exit-distance               Node steps from entrance to exit\n"
+        "  --store-distance              Node steps from entrance to the furthest data store\n"
+    );
+}
+
+bool parse_int(const char* text, int* value)
+{
+    char* end = nullptr;
+    const long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0')
+    {
+        return false;
+    }
+    *value = static_cast<int>(parsed);
+    return true;
+}
+
+bool parse_range(const char* text, Rangei* range)
+{
+    const char* separator = std::strchr(text, '-');
+    if (!separator)
+    {
+        int value = 0;
+        if (!parse_int(text, &value)) { return false; }
+        *range = Rangei(value, value);
+        return true;
+    }
+
+    const std::string min_text(text, separator);
+    return parse_int(min_text.c_str(), &range->min) && parse_int(separator + 1, &range->max);
+}
+
+bool parse_size(const char* text, Size2i* size)
+{
+    const char* separator = std::strchr(text, 'x');
+    if (!separator) { return false; }
+
+    const std::string width_text(text, separator);
+    return parse_int(width_text.c_str(), &size->width) && parse_int(separator + 1, &size->height)
+        && size->width >= networkgenerator::Settings::MinMazeSize && size->height >= networkgenerator::Settings::MinMazeSize;
+}
+
+template<typename GetterType>
+void print_layout_row(const char* name, const std::vector<levelbatch::LevelStats>& levels, GetterType get)
+{
+    unsigned min_value = get(levels.front());
+    unsigned max_value = min_value;
+    double sum = 0.0;
+    for (const auto& stats : levels)
+    {
+        const unsigned value = get(stats);
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+        sum += value;
+    }
+    std::printf("  %-16s %8u %8.2f %8u\n", name, min_value, sum / levels.size(), max_value);
+}
+
+void print_pass_row(const char* name, double seconds, double total_seconds, std::size_t level_count)
+{
+    std::printf("  %-16s %10.1f %12.2f %6.1f%%\n", name, seconds * 1000.0, seconds * 1000000.0 / level_count, total_seconds > 0.0 ? seconds * 100.0 / total_seconds : 0.0);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int first_seed = 0;
+    int seed_count = 1000;
+    int thread_count = static_cast<int>(WorkerPool::get_default_thread_count()) + 1; // The pool runs jobs on this thread too
+    bool list = false;
+    networkgenerator::Settings settings;
+    levelbatch::Constraints constraints;
+
+    for (int arg_index = 1; arg_index < argc; ++arg_index)
+    {
+        const char* arg = argv[arg_index];
+        const char* value = arg_index + 1 < argc ? argv[arg_index + 1] : nullptr;
+        bool valid = true;
+        bool uses_value = true;
+        if (std::strcmp(arg, "--list") == 0) { list = true; uses_value = false; }
+        else if (!value) { valid = false; }
+        else if (std::strcmp(arg, "--first") == 0) { valid = parse_int(value, &first_seed); }
+        else if (std::strcmp(arg, "--count") == 0) { valid = parse_int(value, &seed_count) && seed_count > 0; }
+        else if (std::strcmp(arg, "--size") == 0) { valid = parse_size(value, &settings.maze_size); }
+        else if (std::strcmp(arg, "--threads") == 0) { valid = parse_int(value, &thread_count) && thread_count > 0; }
+        else if (std::strcmp(arg, "--subnets") == 0) { valid = parse_range(value, &constraints.subnet_count); }
+        else if (std::strcmp(arg, "--data-stores") == 0) { valid = parse_range(value, &constraints.data_store_count); }
+        else if (std::strcmp(arg, "--patrols") == 0) { valid = parse_range(value, &constraints.patrol_count); }
+        else if (std::strcmp(arg, "--exit-distance") == 0) { valid = parse_range(value, &constraints.exit_distance); }
+        else if (std::strcmp(arg, "--store-distance") == 0) { valid = parse_range(value, &constraints.furthest_data_store_distance); }
+        else { valid = false; }
+
+        if (!valid)
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+        arg_index += uses_value ? 1 : 0;
+    }
+
+    if (!settings.is_valid())
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    WorkerPool workers(static_cast<std::size_t>(thread_count - 1));
+    const levelbatch::BatchResult result = levelbatch::generate(first_seed, seed_count, settings, constraints, workers);
+    const std::vector<levelbatch::LevelStats>& levels = result.levels;
+
+    std::printf("Generated %zu levels of %dx%d nodes in %.3f s on %d threads: %.0f levels/s\n",
+        levels.size(), settings.maze_size.width, settings.maze_size.height, result.seconds,
+        thread_count, levels.size() / std::max(result.seconds, 0.000001));
+
+    const networkgenerator::PassTimings& timings = result.pass_timings;
+    const double total_seconds = timings.get_total();
+    std::printf("\n  %-16s %10s %12s %7s\n", "Pass", "total ms", "us per level", "share");
+    print_pass_row("blocks", timings.blocks, total_seconds, levels.size());
+    print_pass_row("maze", timings.maze, total_seconds, levels.size());
+    print_pass_row("loops", timings.loops, total_seconds, levels.size());
+    print_pass_row("subnets", timings.subnets, total_seconds, levels.size());
+    print_pass_row("render", timings.render, total_seconds, levels.size());
+    print_pass_row("placement", timings.placement, total_seconds, levels.size());
+
+    std::printf("\n  %-16s %8s %8s %8s\n", "Layout", "min", "avg", "max");
+    print_layout_row("nodes", levels, [](const levelbatch::LevelStats& stats) { return stats.node_count; });
+    print_layout_row("subnets", levels, [](const levelbatch::LevelStats& stats) { return stats.subnet_count; });
+    print_layout_row("data stores", levels, [](const levelbatch::LevelStats& stats) { return stats.data_store_count; });
+    print_layout_row("patrols", levels, [](const levelbatch::LevelStats& stats) { return stats.patrol_count; });
+    print_layout_row("exit distance", levels, [](const levelbatch::LevelStats& stats) { return stats.exit_distance; });
+    print_layout_row("nearest store", levels, [](const levelbatch::LevelStats& stats) { return stats.nearest_data_store_distance; });
+    print_layout_row("furthest store", levels, [](const levelbatch::LevelStats& stats) { return stats.furthest_data_store_distance; });
+
+    std::printf("\n%zu of %zu seeds match the constraints\n", result.matching_seeds.size(), levels.size());
+    if (list)
+    {
+        std::printf("%10s %8s %8s %8s %8s %8s %8s\n", "seed", "subnets", "stores", "patrols", "exit", "nearest", "furthest");
+        for (int seed : result.matching_seeds)
+        {
+            const levelbatch::LevelStats& stats = levels[static_cast<std::size_t>(seed - first_seed)];
+            std::printf("%10d %8u %8u %8u %8u %8u %8u\n", stats.seed, stats.subnet_count, stats.data_store_count, stats.patrol_count,
+                stats.exit_distance, stats.nearest_data_store_distance, stats.furthest_data_store_distance);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}